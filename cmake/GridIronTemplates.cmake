@@ -0,0 +1,34 @@
+# gridiron_compile_templates(<target> DOCROOT <dir> PAGES <front page>...)
+#
+# Compiles each front page (relative to DOCROOT) into C++ with gridiron-templatec and adds the result to
+# <target>. For a page foo/bar.html the target can #include "bar.hpp" and use GridIron::compiled::bar.
+# Once main calls GridIron::compiled::bar::Preload(), the page is served from the binary; the html file
+# isn't read at runtime.
+function(gridiron_compile_templates target)
+    cmake_parse_arguments(GRIDIRON_TEMPLATES "" "DOCROOT" "PAGES" ${ARGN})
+    if(NOT GRIDIRON_TEMPLATES_DOCROOT)
+        message(FATAL_ERROR "gridiron_compile_templates: DOCROOT is required")
+    endif()
+
+    set(output_dir ${CMAKE_CURRENT_BINARY_DIR}/gridiron_templates)
+    file(MAKE_DIRECTORY ${output_dir})
+
+    foreach(page ${GRIDIRON_TEMPLATES_PAGES})
+        get_filename_component(name ${page} NAME_WE)
+        string(MAKE_C_IDENTIFIER ${name} ident)
+        set(input ${GRIDIRON_TEMPLATES_DOCROOT}/${page})
+        set(header ${output_dir}/${ident}.hpp)
+        set(source ${output_dir}/${ident}.cpp)
+
+        add_custom_command(
+            OUTPUT ${header} ${source}
+            COMMAND gridiron-templatec ${page} ${input} ${ident} ${header} ${source}
+            DEPENDS gridiron-templatec ${input}
+            COMMENT "Compiling front page ${page}"
+            VERBATIM
+        )
+        target_sources(${target} PRIVATE ${header} ${source})
+    endforeach()
+
+    target_include_directories(${target} PRIVATE ${output_dir})
+endfunction()
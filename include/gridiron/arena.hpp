@@ -0,0 +1,84 @@
+/****************************************************************************************
+ * (C) Copyright 2009-2024
+ *    Jessica Mulein <jessica@digitaldefiance.org>
+ *    Digital Defiance and Contributors <https://digitaldefiance.org>
+ *
+ * Others will be credited if more developers join.
+ *
+ * License
+ *
+ * This code is licensed under the Apache license.
+ * Please see COPYING in the root of this package for details.
+ *
+ * The following libraries are only linked in, and no code is based directly from them:
+ * htmlcxx is under the Apache 2.0 License
+ ***************************************************************************************
+ * Arena Class
+ * -----------
+ *
+ * Monotonic allocator owning everything created for one page: controls, their child
+ * lists, scratch strings. Allocation is a pointer bump (the first few KB come from an
+ * inline buffer), nothing is freed individually, and the whole lot is released in one
+ * go when the page is destroyed. Objects made with Create() have their destructors
+ * run at that point, newest first.
+ ***************************************************************************************/
+
+#ifndef _ARENA_HPP_
+#define _ARENA_HPP_
+
+#include <cstddef>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace GridIron
+{
+    class Arena
+    {
+    public:
+        Arena();
+        ~Arena();
+        Arena(const Arena &) = delete;
+        Arena &operator=(const Arena &) = delete;
+
+        // construct a T in the arena. The arena owns it: don't delete it, it goes away with the arena.
+        template <class T, class... Args>
+        T *Create(Args &&...args)
+        {
+            Finalizer *finalizer = nullptr;
+            if constexpr (!std::is_trivially_destructible_v<T>)
+                finalizer = static_cast<Finalizer *>(_resource.allocate(sizeof(Finalizer), alignof(Finalizer)));
+
+            T *object = new (_resource.allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+
+            if constexpr (!std::is_trivially_destructible_v<T>)
+                _finalizers = new (finalizer) Finalizer{object, &destroy<T>, _finalizers};
+            return object;
+        }
+
+        void Clear(); // destroy everything made with Create() and release all memory
+
+        // for pmr containers and strings that should live in the arena
+        inline std::pmr::memory_resource *Resource() { return &_resource; };
+
+    private:
+        struct Finalizer
+        {
+            void *object;
+            void (*destroy)(void *object);
+            Finalizer *next;
+        };
+
+        template <class T>
+        static void destroy(void *object) { static_cast<T *>(object)->~T(); }
+
+        static constexpr size_t InlineBytes = 4096;
+
+        alignas(std::max_align_t) std::byte _inline[InlineBytes];
+        std::pmr::monotonic_buffer_resource _resource;
+        Finalizer *_finalizers = nullptr; // newest first
+    };
+}
+
+#endif
@@ -28,11 +28,17 @@
 #include <string>
 #include <iostream>
 #include <fstream>
+#include <gridiron/gridiron.hpp>
 #include <gridiron/exceptions.hpp>
+#include <gridiron/arena.hpp>
+#include <gridiron/outputcache.hpp>
+#include <gridiron/viewstate.hpp>
 #include <sstream>
 #include <vector>
 #include <map>
 #include <memory>
+#include <memory_resource>
+#include <string_view>
 
 namespace GridIron
 {
@@ -42,38 +48,34 @@ namespace GridIron
 
     class ControlFactoryProxyBase;
 
-    // map between control id's and control instances
-    typedef std::map<std::string, std::shared_ptr<Control>> control_map;
-    typedef std::vector<std::shared_ptr<Control>> vector_control_children;
+    // non-owning: controls under a page are owned by the page's arena (or by whoever declared them)
+    typedef std::pmr::vector<Control *> vector_control_children;
 
     // custom control base class, must derive
-    class Control : public std::enable_shared_from_this<Control>
+    class Control
     {
     protected:
-        Control(std::string id, std::shared_ptr<Control> parent); // parent can be page type or control type
+        Control(std::string id, Control *parent); // parent can be page type or control type
     public:
         static const std::string HtmlNamespace; // gridiron namespace so it can be accessed as a regvar (needs pointed to string)
 
         static std::string GetFullName(std::string tag);
 
         virtual ~Control(); // destructor
-        std::shared_ptr<Control>
-        GetPage(); // return pointer to parent page object (or self for page)
-        std::shared_ptr<Control>
-        GetRoot(); // return pointer to the parent control object, regardless of type.
-        std::shared_ptr<Control> This();
+        Page *GetPage();        // return pointer to parent page object (or self for page), nullptr if not under a page
+        Control *GetRoot();     // return pointer to the bottom-most control object, regardless of type.
 
-        std::shared_ptr<Control> Find(Control &control);
+        Control *Find(Control &control); // the instance if it is registered on our page
 
-        std::shared_ptr<Control> FindByID(const std::string &id,
-                                          bool searchParentsIfNotChild = false); // find by id, starting with the current instance
+        Control *FindByID(const std::string &id,
+                          bool searchParentsIfNotChild = false); // find by id, starting with the current instance
         std::ostream &fullName(std::ostream &os);
 
         std::string fullName();
 
         friend std::ostream &operator<<(std::ostream &os, const Control &control);
 
-        void SetHTMLNode(htmlnode *node);
+        void SetHTMLNode(const htmlnode *node);
 
         inline bool HTMLNodeRegistered() { return (this->_htmlNode != NULL); };
 
@@ -81,7 +83,7 @@ namespace GridIron
             bool isauto); // set whether the control is in html only (no C++ instance pre-programmed)
         inline virtual bool IsAutonomous(
             bool isauto) { return this->_autonomous; };      // whether the control is in html only (no C++ instance pre-programmed)
-        inline const std::string ID() { return this->_id; }; // return our ID
+        inline const std::string &ID() const { return this->_id; }; // return our ID
 
         template <typename Base, typename T>
         static inline bool instanceOf(const T *ptr)
@@ -92,9 +94,50 @@ namespace GridIron
         virtual std::string controlTagName() const = 0; // the associated codebeside tag name eg <namespace>::<tag>
         virtual std::string renderTagName() const = 0;  // the associated html tag name eg <div>
 
-        static std::shared_ptr<Control> fromHtmlNode(htmlnode &node);
+        // called by the page when this instance is matched to its tag. source is the front page html
+        // the node's offsets refer to. We're already bound to the tag's slot, see Template::Fragments.
+        virtual void fromHtmlNode(const htmlnode &node, std::string_view source);
+
+        virtual void render(std::string &data) = 0; // append our html to data
+
+        // state kept across postbacks in the page's ViewState, only for controls that have it enabled
+        inline void SetViewStateEnabled(bool enabled) { _viewStateEnabled = enabled; };
+        inline bool ViewStateEnabled() const { return _viewStateEnabled; };
+        inline bool ViewStateValid() const { return _viewStateValid; };   // restored from an authenticated token
+        virtual void SaveViewState(ViewStateWriter &writer);              // write our properties, our control is already begun
+        virtual void LoadViewState(const ViewStateControl &state);        // restore what SaveViewState wrote
+        inline virtual bool RendersViewState() const { return false; };   // our output is the page's ViewState
+
+        // postback, driven by Page::ProcessPostBack. Form fields are matched to controls by id.
+        virtual bool LoadPostData(std::string_view value);          // our field was posted, true if that changed us
+        virtual void RaisePostDataChanged();                        // once all fields are loaded, if LoadPostData said so
+        inline virtual bool RaisesPostBackEvents() const { return false; }; // our field being posted means we sent the form
+        virtual void RaisePostBackEvent(std::string_view argument); // we sent the form (e.g. the button clicked), last of all
+
+        // call after changing anything render() uses, so a page kept around with Page::Refresh re-renders us.
+        // a control the page doesn't render directly (a child) marks the ancestor that it does.
+        void MarkDirty();
+
+        // reuse our rendered html across requests, see outputcache.hpp. On a page it caches the whole page.
+        void SetOutputCache(const OutputCachePolicy &policy); // a zero duration turns it back off
+        inline const OutputCachePolicy *GetOutputCache() const { return _outputCache.get(); }; // nullptr if not cached
+
+        // our render() only reads our own state, so the page may run it on the RenderPool alongside the rest of the
+        // page (see renderpool.hpp). For controls whose render is slow, e.g. waits on a data lookup.
+        inline void SetRenderIndependent(bool independent) { _renderIndependent = independent; };
+        inline bool RenderIndependent() const { return _renderIndependent; };
+
+        // async render: a control whose data comes from elsewhere (a db or cache fetch) isn't ready until it is in,
+        // and then calls NotifyReady, from whatever thread. A page streamed through a PageReader stops in front of it
+        // and waits (an async endpoint yields) instead of holding a thread, render() blocks.
+        inline virtual bool ReadyToRender() const { return true; }; // must be safe to call from any thread
+        void NotifyReady();
 
     protected:
+        friend class Page; // binds us to a render slot
+
+        static constexpr size_t NoSlot = static_cast<size_t>(-1);
+
         inline static const bool AllowAutonomous() { return false; } // can't have a base class anyway
         virtual bool
         registerChild(std::string id, Control *control); // add child control's id and name to the bimap
@@ -102,92 +145,106 @@ namespace GridIron
         unregister_child(std::string &id); // delete child control's id and name from the bimap
 
         std::string _id;                   // our id
-        vector_control_children _children; // collection of pointers to child controls, by their address
-        std::shared_ptr<Control> _parent;  // parent's pointer
+        Control *_parent;                  // parent's pointer, nullptr for pages
+        vector_control_children _children; // collection of pointers to child controls, allocated from the page's arena
         std::string _parsed;               // data after parsing- only data relevant to our id
         bool _viewStateEnabled = false;    // whether to bother serializing this object
         bool _viewStateValid = false;      // whether viewstate was authenticated
         bool _autonomous = false;          // control does not have a pre-programmed instance, instantiated from the HTML
+        bool _renderIndependent = false;   // safe to render at the same time as other independent controls
+        std::unique_ptr<OutputCachePolicy> _outputCache; // set if our output is cached
+        size_t _renderSlot = NoSlot;       // the page's control slot we're bound to
 
         /* These vars correspond to whether (and where) the C++ instance has been matched to an HTML instance (and only one)
          * Multiple detections of HTML tags with the same ID should cause an error, regardless of type
          * Similarly, the page should only be able to contain one control of a given ID
          */
-        htmlnode *_htmlNode; // the associated html node
+        const htmlnode *_htmlNode; // the associated html node (owned by the shared Template, read-only)
         std::string _text;
 
-        // memory overhead warning...
-        static std::map<std::string, std::shared_ptr<Control>> _controlsByID;
-        static std::map<Control *, std::shared_ptr<Control>> _controlsByControl;
-        static std::map<std::string, std::shared_ptr<Control>> _controlsByNamespace;
-        static std::map<std::string, std::shared_ptr<Control>> _controlsByControlTag;
-        static std::set<std::string> _registeredNamespaces;
+        // NOTE: there is no process-wide control index. Controls are indexed by the ControlRegistry
+        // of the Page they live on, so pages rendering in parallel share no mutable state.
     };
 
     // --------------------------------------------------------------------
     // Thank you Dr. Dobbs - August 01, 1998 (http://www.ddj.com/184410633)
     // See control.cpp for comments specific to this implementation
-    // NOTE: the order of declaration here is very sensitive
+    //
+    // Control types are registered by name once, at startup. Lookups by name (for every auto tag
+    // on every page) are a binary search over a flat sorted array and never allocate.
 
-    typedef std::vector<const ControlFactoryProxyBase *> factory_vector;
+    // (type name, proxy) sorted by type name
+    typedef std::vector<std::pair<std::string_view, const ControlFactoryProxyBase *>> factory_vector;
 
     // definition for our class in charge of registering, finding, and instantiating control classes
     // by their type
     class ControlFactory
     {
     public:
-        ControlFactory();
+        static ControlFactory &Instance(); // created on first use, so registering from static initializers is safe
 
-        ~ControlFactory();
+        bool Register(const ControlFactoryProxyBase *proxy); // false if the type name is already taken
 
-        void Register(const ControlFactoryProxyBase *proxy);
+        // the new control lives in arena (normally the page's) and is destroyed with it
+        Control *CreateByType(std::string_view type, const std::string &id, Control *parent, Arena &arena);
 
-        Control *CreateByType(const char *type, const char *id, Control *parent);
+        const ControlFactoryProxyBase *Find(std::string_view type) const;
 
-        int GetCount();
+        int GetCount() const;
 
-        const ControlFactoryProxyBase *GetAt(int i);
+        const ControlFactoryProxyBase *GetAt(int i) const;
 
     private:
-        void Init();
+        ControlFactory() = default;
 
-        factory_vector *_controlProxies;
+        factory_vector _controlProxies;
     };
 
-    // global instance created in control.cpp
-    extern ControlFactory globalControlFactory;
-
-    // each proxy, when instantiated by the derived control class will register it self with the
-    // control factory. This will be derived by the template class that follows.
+    // the derived template class below knows how to make one kind of control
     class ControlFactoryProxyBase
     {
     public:
-        inline ControlFactoryProxyBase()
-        {
-            globalControlFactory.Register(this);
-        }
+        virtual ~ControlFactoryProxyBase() = default;
 
-        virtual Control *CreateObject(const char *id, Control *parent, std::string type) const = 0;
-        virtual const char *GetType() const = 0;
+        virtual Control *CreateObject(const std::string &id, Control *parent, Arena &arena) const = 0;
+        virtual std::string_view GetType() const = 0;
     };
 
-    // instantiate one of these in the .cpp file of every derived control class you want autos for
     template <class T>
     class ControlFactoryProxy : public ControlFactoryProxyBase
     {
-        inline virtual Control *CreateObject(const char *id, Control *parent, std::string type) const
+    public:
+        static const ControlFactoryProxy &Instance()
+        {
+            static const ControlFactoryProxy proxy;
+            return proxy;
+        }
+
+        inline Control *CreateObject(const std::string &id, Control *parent, Arena &arena) const override
         {
             if (!T::AllowAutonomous())
-                return NULL;
-            Control *pointer = new T(id, parent, type);
-            if (pointer == NULL)
-                return NULL;
+                return nullptr;
+            Control *pointer = arena.Create<T>(id, parent);
             pointer->Control::SetAutonomous(true);
             return pointer;
         }
-        inline virtual const char *GetType() const
+
+        inline std::string_view GetType() const override
+        {
+            return T::TypeName;
+        }
+    };
+
+    // compile-time list of control types to register with the factory. Instantiate one of these as a static in
+    // the .cpp file of the control classes you want autos for (each class needs a static TypeName), e.g.
+    //   static const GridIron::ControlTypeList<Calendar, Grid> registerControls;
+    // The built-in controls are already registered, see ControlFactory::Instance.
+    template <class... T>
+    struct ControlTypeList
+    {
+        ControlTypeList()
         {
-            return T::Type();
+            (ControlFactory::Instance().Register(&ControlFactoryProxy<T>::Instance()), ...);
         }
     };
 }
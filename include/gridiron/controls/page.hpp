@@ -29,13 +29,24 @@
 
 // local
 #include <gridiron/gridiron.hpp>
+#include <gridiron/template.hpp>
 #include <gridiron/controls/control.hpp>
+#include <gridiron/controls/registry.hpp>
+#include <gridiron/formdata.hpp>
+#include <gridiron/arena.hpp>
+#include <gridiron/renderpool.hpp>
 // STL
+#include <atomic>
+#include <exception>
 #include <vector>
 #include <string>
 #include <map>
+#include <unordered_map>
 #include <fstream>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <condition_variable>
 
 namespace GridIron
 {
@@ -43,25 +54,74 @@ namespace GridIron
 
     class Control;
 
-    // map node instances to control instances
-    typedef std::map<const htmlnode *, Control *> node_map;
-    // map variable names to their data
-    typedef std::map<const std::string, std::string *> var_map;
+    // control instances bound to the template's control slots
+    typedef std::vector<Control *> control_slots;
+    // variables bound to the template's value slots
+    typedef std::vector<std::string *> value_slots;
+    // variables no Value tag on the page refers to, by name
+    typedef std::unordered_map<std::string, std::string *> var_map;
+
+    std::ostream &operator<<(std::ostream &os, Page &page);
+
+    class PageReader;
 
     // page classes are derived from control classes. They must have no parent (NULL).
     class Page : public Control
     {
     public:
-        Page(std::string frontPage);
-
-        std::shared_ptr<Page> This();
+        Page(std::string frontPage);                                     // path under the docroot, loaded via the TemplateCache
+        Page(std::string id, std::shared_ptr<const Template> frontPage); // already loaded front page
 
         ~Page();
 
-        friend std::ostream &operator<<(std::ostream &os, const Control &control);
+        // create a control directly under this page, owned by the page: it is destroyed along with the page,
+        // never delete it yourself. e.g. auto lblTest = page->Create<controls::Label>("lblTest");
+        template <class T, class... Args>
+        T *Create(const std::string &id, Args &&...args)
+        {
+            return _arena.Create<T>(id, this, std::forward<Args>(args)...);
+        }
+
+        void render(std::string &data) override; // render the whole page, appending to data
+
+        // the whole page, kept between calls. The first call renders it all, after that only controls and
+        // variables marked dirty since the last call are re-rendered and spliced in.
+        const std::string &Refresh();
+        void VariableChanged(const std::string *data); // call after changing a registered variable's value
+
+        // ViewState of every control that has it enabled, as a token for the __VIEWSTATE field. Empty if there is none.
+        std::string SerializeViewState();
+        // give controls back their state from a posted token. false (and nothing restored) if it doesn't authenticate.
+        bool RestoreViewState(std::string_view token);
+
+        // handle a posted form, before render: restore the ViewState, hand every field to the control with its id, then
+        // raise the change events and last the postback event, in one batch once all the fields are in. So handlers see
+        // every posted value, whatever order the fields came in. false if a posted ViewState didn't authenticate.
+        bool ProcessPostBack(const FormData &form);
+        inline bool IsPostBack() const { return _isPostBack; }; // ProcessPostBack was called
+
+        static constexpr std::string_view ViewStateField = "__VIEWSTATE";
+        static constexpr std::string_view EventTargetField = "__EVENTTARGET";     // id of the control sending the form, if scripted
+        static constexpr std::string_view EventArgumentField = "__EVENTARGUMENT"; // passed to its RaisePostBackEvent
+
+        // async render, see Control::ReadyToRender
+        bool Ready() const; // every bound control is ready to render
+        void WaitReady();   // block until Ready()
+        // called, on the notifying control's thread, whenever a control says it's ready. For waking whoever waits to
+        // stream the page; it must be quick, and it must not touch the page. Pass nullptr to stop being called.
+        void SetReadyListener(std::function<void()> listener);
+
+        inline ControlRegistry &Registry() { return _registry; }; // the controls living on this page, by id
+        inline Arena &GetArena() { return _arena; };              // memory for everything living on this page
+        inline const std::shared_ptr<const Template> &GetTemplate() const { return _template; }; // nullptr without a front page
 
         bool
-        RegisterVariable(const std::string name, std::string *data); // register a variable for front-page access
+        RegisterVariable(const std::string &name, std::string *data); // register a variable for front-page access
+        std::string *GetVariable(const std::string &name);            // the registered variable, nullptr if none
+
+        // the request's query parameters, for output cache vary-by keys
+        void SetQueryParameter(const std::string &name, std::string value);
+        const std::string *GetQueryParameter(const std::string &name) const; // nullptr if the request didn't have it
         inline static const bool AllowAutonomous() { return false; } // can't have an autonomous page class
 
         static const std::string PathToPage(std::string frontPage);
@@ -74,12 +134,102 @@ namespace GridIron
         }
 
     protected:
-        tree<htmlnode> _tree;      // html tree
-        var_map _regvars;          // registered variables for frontpage access
-        node_map _nodemap;         // registered nodes
+        friend class PageReader;
+        friend class Control; // MarkDirty
+
+        // where a Control or Value op's output sits in _retained
+        struct RetainedSpan
+        {
+            size_t op;
+            size_t offset;
+            size_t length;
+        };
+
+        void bind();                                           // bind control instances to the template's control slots (see page.cpp)
+        void renderSlot(const RenderOp &op, std::string &data); // render a Control or Value op
+        void renderPlan(std::string &data);                     // run the render plan, no caching
+        // render the independent controls of the plan at the same time, output of plan op ops[i] into rendered[i].
+        // Left empty (they render inline) unless there are at least two.
+        void renderIndependent(std::vector<size_t> &ops, std::vector<std::string> &rendered);
+
+        // output of a control with an output cache policy (or of the page, for the page itself), from the cache if possible
+        std::shared_ptr<const std::string> renderCached(Control &control);
+        bool cached(const Control &control) const; // control (or the page) goes through renderCached
+        void outputCacheKey(const Control &control, std::string &key); // front page, id and vary-by values
+        void controlChanged(size_t slot);                               // a bound control was marked dirty
+        void controlReady();                                            // a control's data came in, any thread
+        const std::string &viewStateScope() const;                      // what our ViewState tokens are tied to
+
+        ControlRegistry _registry;                 // this page's controls, nothing is shared between pages
+        Arena _arena;                              // owns autos and controls made with Create(), must outlive nothing but the page
+        std::shared_ptr<const Template> _template; // parsed front page, shared with other requests
+        bool _autosCreated = false;                // the autos have been created (or given up on)
+        size_t _unbound = 0;                       // control slots bind() still has to fill
+        control_slots _controls;   // bound controls, by template control slot
+        value_slots _values;       // bound variables, by template value slot (RegisterVariable writes straight in)
+        var_map _regvars;          // registered variables the template doesn't use
+        std::unordered_map<std::string, std::string> _query; // query parameters, by name
+        std::string _retained;             // output of the last Refresh
+        bool _retainedValid = false;       // _retained holds a full render
+        std::vector<RetainedSpan> _spans;  // the Control and Value ops in _retained, in plan order
+        // controls may change (and mark themselves dirty) from other threads, see Control::NotifyReady
+        std::vector<std::atomic<bool>> _dirtyControls; // by control slot, changed since the last Refresh
+        std::vector<std::atomic<bool>> _dirtyValues;   // by value slot, same
+        std::atomic<bool> _anyDirty{false};
+        size_t _viewStateSlot = NoSlot;    // control slot showing the ViewState, it changes whenever any control does
+        bool _isPostBack = false;
+        std::mutex _readyLock;                  // WaitReady and the listener vs controls becoming ready
+        std::condition_variable _readyChanged;
+        std::function<void()> _readyListener;
         std::string _htmlFile;     // front page filename
         std::string _htmlFilepath; // front page filename full path
     };
+
+    // Pulls a page's output in caller sized pieces, for streaming it out while it renders.
+    // Literal spans are copied straight from the shared template into the caller's buffer,
+    // only controls and variables are rendered (one slot at a time, into a small scratch string).
+    // The page must not be modified while it is being read.
+    // A Read fills the whole buffer unless it reaches a <GridIron::Flush /> in the template: then it returns what it
+    // has, so the part of the page above a slow control reaches the client before that control is rendered.
+    // Independent controls (see Control::SetRenderIndependent) all start rendering on the RenderPool at the first Read,
+    // and go out in plan order as they finish.
+    class PageReader
+    {
+    public:
+        PageReader(std::shared_ptr<Page> page);
+        PageReader(const PageReader &) = delete; // the controls rendering on the pool write into us
+        PageReader &operator=(const PageReader &) = delete;
+
+        size_t Read(char *buffer, size_t count); // fill up to count bytes, returns 0 once the page is done
+        inline bool Done() const { return _started && _pending.empty() && _op == _plan.size(); };
+        // the last Read stopped in front of a control that isn't ready to render, or is still rendering on the pool.
+        // Read again once it is (the page's ready listener is called), it picks up from there.
+        inline bool Waiting() const { return _waiting; };
+        void Wait(); // block until what the last Read stopped in front of is ready
+
+        inline const std::shared_ptr<Page> &GetPage() const { return _page; };
+
+    private:
+        bool next();          // load the next op into _pending, false when the plan is exhausted
+        void startParallel(); // start the independent controls on the pool
+
+        std::shared_ptr<Page> _page;
+        render_plan _plan;         // the page's template plan, kept alive by the page
+        size_t _op = 0;            // next op to load
+        std::string_view _pending; // unread output of the current op
+        std::string _scratch;      // output of the current control op
+        std::shared_ptr<const std::string> _cached; // output of the current op (or whole page) from the output cache
+        bool _started = false;
+        bool _wholePage = false; // the page is output cached, it goes out in one piece once everything's ready
+        bool _waiting = false;
+
+        std::vector<size_t> _parallelOps;                  // plan ops rendering on the pool, in plan order
+        std::vector<std::string> _rendered;                // their output
+        std::vector<std::exception_ptr> _renderErrors;     // what they threw, rethrown when read
+        std::unique_ptr<std::atomic<bool>[]> _renderDone;  // set once output (or error) is in
+        size_t _nextParallel = 0;                          // next of _parallelOps to read
+        RenderPool::Started _parallel;                     // last, so it's waited on before the rest goes away
+    };
 }
 
 #endif
@@ -0,0 +1,103 @@
+/****************************************************************************************
+ * (C) Copyright 2009-2024
+ *    Jessica Mulein <jessica@digitaldefiance.org>
+ *    Digital Defiance and Contributors <https://digitaldefiance.org>
+ *
+ * Others will be credited if more developers join.
+ *
+ * License
+ *
+ * This code is licensed under the Apache license.
+ * Please see COPYING in the root of this package for details.
+ *
+ * The following libraries are only linked in, and no code is based directly from them:
+ * htmlcxx is under the Apache 2.0 License
+ ***************************************************************************************
+ * ControlRegistry Class
+ * ---------------------
+ *
+ * Every Page owns one of these. It indexes the controls living under that page by id,
+ * so ids only have to be unique per page and concurrent requests never share state.
+ *
+ * Open addressing over a flat array of (hash, control) pairs. Keys are views of the
+ * controls' own id strings, so registering never copies the id. The first table lives in
+ * an inline buffer, so small pages don't touch the heap at all. Bigger tables come from
+ * the heap and are freed when replaced, so register/unregister churn on a long-lived page
+ * doesn't keep growing it.
+ ***************************************************************************************/
+
+#ifndef _REGISTRY_HPP_
+#define _REGISTRY_HPP_
+
+#include <cstddef>
+#include <memory_resource>
+#include <string_view>
+#include <vector>
+
+namespace GridIron
+{
+    class Control;
+
+    class ControlRegistry
+    {
+    public:
+        ControlRegistry();
+        ControlRegistry(const ControlRegistry &) = delete;
+        ControlRegistry &operator=(const ControlRegistry &) = delete;
+
+        bool Register(Control *control);          // false if the id is empty or already taken
+        bool Unregister(Control *control);        // false if that instance wasn't registered
+        Control *Find(std::string_view id) const; // nullptr if not found
+
+        inline size_t Count() const { return _count; };
+
+        // call f(Control *) for every registered control, in no particular order. f must not register or unregister.
+        template <class F>
+        void ForEach(F &&f) const
+        {
+            for (const Slot &slot : _slots)
+            {
+                if (slot.control != nullptr && slot.control != Tombstone)
+                    f(slot.control);
+            }
+        }
+
+    private:
+        struct Slot
+        {
+            size_t hash;
+            Control *control; // nullptr = empty, Tombstone = removed
+        };
+
+        // hands out the inline buffer while it's free, anything else goes to the heap
+        class inlineResource : public std::pmr::memory_resource
+        {
+        public:
+            inlineResource(void *buffer, size_t size) : _buffer(buffer), _size(size) {}
+
+        protected:
+            void *do_allocate(size_t bytes, size_t alignment) override;
+            void do_deallocate(void *p, size_t bytes, size_t alignment) override;
+            bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override { return this == &other; }
+
+        private:
+            void *_buffer;
+            size_t _size;
+            bool _inUse = false;
+        };
+
+        static Control *const Tombstone;
+        static constexpr size_t InitialCapacity = 32; // power of two
+
+        size_t probe(std::string_view id, size_t hash) const; // index of id, or of the empty slot ending the probe
+        void grow();
+
+        alignas(Slot) std::byte _inline[InitialCapacity * sizeof(Slot)];
+        inlineResource _resource;
+        std::pmr::vector<Slot> _slots;
+        size_t _count = 0; // live entries
+        size_t _used = 0;  // live entries + tombstones
+    };
+}
+
+#endif
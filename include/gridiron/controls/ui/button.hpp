@@ -0,0 +1,80 @@
+/****************************************************************************************
+ * (C) Copyright 2009-2024
+ *    Jessica Mulein <jessica@digitaldefiance.org>
+ *    Digital Defiance and Contributors <https://digitaldefiance.org>
+ *
+ * Others will be credited if more developers join.
+ *
+ * License
+ *
+ * This code is licensed under the Apache license.
+ * Please see COPYING in the root of this package for details.
+ *
+ * The following libraries are only linked in, and no code is based directly from them:
+ * htmlcxx is under the Apache 2.0 License
+ ***************************************************************************************
+ * gridiron::Button custom control class
+ * -------------------------------------
+ *
+ * A submit button. Pressing it posts the form, and OnClick is raised on the server
+ * after every other posted field has been loaded.
+ ***************************************************************************************/
+
+#ifndef _BUTTON_HPP_
+#define _BUTTON_HPP_
+
+#include <gridiron/controls/control.hpp>
+#include <gridiron/template.hpp>
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace GridIron
+{
+    namespace controls
+    {
+        class Button : public Control
+        {
+        public:
+            typedef std::function<void(Button &, std::string_view)> click_handler; // the button and the event argument
+
+            Button(std::string id, Control *parent);
+
+            Button(std::string id, Control *parent, std::string text);
+
+            void SetText(std::string value); // the caption
+            inline const std::string &GetText() const { return _text; };
+
+            inline void OnClick(click_handler handler) { _onClick = std::move(handler); };
+
+            inline static const bool AllowAutonomous() { return true; }
+
+            static constexpr std::string_view TypeName = "Button"; // <GridIron::Button value="caption">
+
+            void fromHtmlNode(const htmlnode &node, std::string_view source) override; // pick up the default caption
+
+            void render(std::string &data) override; // <input type="submit" id="..." name="..." value="..." />
+
+            inline bool RaisesPostBackEvents() const override { return true; };
+            void RaisePostBackEvent(std::string_view argument) override;
+
+            std::string controlTagName() const override {
+                return std::string(TypeName);
+            }
+            std::string renderTagName() const override {
+                return "input";
+            }
+
+        private:
+            static void openTag(std::string &data, std::string_view id); // <input ... value="
+            static void buildFragments(const Template &compiled, size_t slot, StaticFragments &fragments);
+
+            const StaticFragments *_fragments = nullptr; // our tag's opening part, if bound
+            bool _defaulttext;
+            std::string _text;
+            click_handler _onClick;
+        };
+    }
+}
+
+#endif
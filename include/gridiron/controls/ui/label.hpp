@@ -27,6 +27,7 @@
  */
 
 #include <gridiron/controls/control.hpp>
+#include <gridiron/template.hpp>
 #include <string>
 #include <fstream>
 
@@ -42,46 +43,67 @@ namespace GridIron
         class Label : public Control
         {
         public:
-            Label(std::string id, std::shared_ptr<Control> parent);
+            Label(std::string id, Control *parent);
 
-            Label(std::string id, std::shared_ptr<Control> parent, std::string text);
+            Label(std::string id, Control *parent, std::string text);
 
             ~Label();
 
-            inline void SetText(std::string value)
-            {
-                _text = value;
-                _defaulttext = false;
-            }; // set the text and mark it as changed
-            inline std::string GetText() { return _text; };
+            void SetText(std::string value); // set the text and mark it as changed
+            inline std::string GetText() { return _textShared ? _text : std::string(textView()); };
 
-            inline std::string *const GetTextPtr() { return &_text; };
+            std::string *const GetTextPtr(); // the text as a variable, kept up to date from then on
 
-            inline void SetHeight(int value) { _height = value; };
+            inline void SetHeight(int value)
+            {
+                _height = value;
+                MarkDirty();
+            };
 
             inline int GetHeight() { return _height; };
 
-            inline void SetWidth(int value) { _width = value; };
+            inline void SetWidth(int value)
+            {
+                _width = value;
+                MarkDirty();
+            };
 
             inline int GetWidth() { return _width; };
 
             inline static const bool AllowAutonomous() { return true; }
 
+            static constexpr std::string_view TypeName = "Label"; // <GridIron::Label>
+
+            void fromHtmlNode(const htmlnode &node, std::string_view source) override; // pick up the default text
+
+            void render(std::string &data) override; // <div style="..." id="...">text</div>
+
+            void SaveViewState(ViewStateWriter &writer) override; // text (if changed), height and width
+            void LoadViewState(const ViewStateControl &state) override;
+
             friend std::ostream &operator<<(std::ostream &os, Label &label);
 
        std::string controlTagName() const override {
-            return "Label";
+            return std::string(TypeName);
         }
         std::string renderTagName() const override {
             return "div";
         }
 
         private:
+            // the text, without copying the template's default unless something holds a pointer to it
+            inline std::string_view textView() const { return (_defaulttext && !_textShared) ? _defaultText : std::string_view(_text); };
+            static void openTag(std::string &data, std::string_view id, int height, int width); // <div style=... id=...>
+            static void buildFragments(const Template &compiled, size_t slot, StaticFragments &fragments);
+
             bool _defaulttext;
+            bool _textShared = false;           // _text was handed out (or registered), it has to hold the text
             std::string _text;
+            std::string_view _defaultText;      // contents of our tag, in the shared template
+            const StaticFragments *_fragments = nullptr; // our tag's opening tag and encoded default text, if bound
             std::string _style;
-            int _height;
-            int _width;
+            int _height = 0;
+            int _width = 0;
 
             // TODO: expand to handle most/all properties and deal with the overlap
             // between the properties and parsing the style argument.
@@ -89,6 +111,8 @@ namespace GridIron
             // but the template Tag may have a style="height: 14px;" - in which case, we have a conflict
             // the label should get the template values at instantiation, and allow to be changed before render
         };
+
+        std::ostream &operator<<(std::ostream &os, Label &label);
     }
 }
 
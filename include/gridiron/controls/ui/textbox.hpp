@@ -0,0 +1,86 @@
+/****************************************************************************************
+ * (C) Copyright 2009-2024
+ *    Jessica Mulein <jessica@digitaldefiance.org>
+ *    Digital Defiance and Contributors <https://digitaldefiance.org>
+ *
+ * Others will be credited if more developers join.
+ *
+ * License
+ *
+ * This code is licensed under the Apache license.
+ * Please see COPYING in the root of this package for details.
+ *
+ * The following libraries are only linked in, and no code is based directly from them:
+ * htmlcxx is under the Apache 2.0 License
+ ***************************************************************************************
+ * gridiron::TextBox custom control class
+ * --------------------------------------
+ *
+ * A single line text input. Takes its text back from the form on postback and
+ * raises OnTextChanged if the user changed it.
+ ***************************************************************************************/
+
+#ifndef _TEXTBOX_HPP_
+#define _TEXTBOX_HPP_
+
+#include <gridiron/controls/control.hpp>
+#include <gridiron/template.hpp>
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace GridIron
+{
+    namespace controls
+    {
+        class TextBox : public Control
+        {
+        public:
+            typedef std::function<void(TextBox &)> text_changed_handler;
+
+            TextBox(std::string id, Control *parent);
+
+            TextBox(std::string id, Control *parent, std::string text);
+
+            void SetText(std::string value); // set the text and mark it as changed
+            inline const std::string &GetText() const { return _text; };
+
+            inline std::string *const GetTextPtr() { return &_text; };
+
+            // called after a postback changed the text, once every posted field is loaded
+            inline void OnTextChanged(text_changed_handler handler) { _onTextChanged = std::move(handler); };
+
+            inline static const bool AllowAutonomous() { return true; }
+
+            static constexpr std::string_view TypeName = "TextBox"; // <GridIron::TextBox value="...">
+
+            void fromHtmlNode(const htmlnode &node, std::string_view source) override; // pick up the default text
+
+            void render(std::string &data) override; // <input type="text" id="..." name="..." value="..." />
+
+            void SaveViewState(ViewStateWriter &writer) override; // text (if changed), to tell what the user changed
+            void LoadViewState(const ViewStateControl &state) override;
+
+            bool LoadPostData(std::string_view value) override;
+            void RaisePostDataChanged() override;
+
+            std::string controlTagName() const override {
+                return std::string(TypeName);
+            }
+            std::string renderTagName() const override {
+                return "input";
+            }
+
+        private:
+            static void openTag(std::string &data, std::string_view id); // <input ... value="
+            static void buildFragments(const Template &compiled, size_t slot, StaticFragments &fragments);
+
+            const StaticFragments *_fragments = nullptr; // our tag's opening part, if bound
+            bool _defaulttext;
+            std::string _text;
+            text_changed_handler _onTextChanged;
+        };
+    }
+}
+
+#endif
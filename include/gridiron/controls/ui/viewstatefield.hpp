@@ -0,0 +1,58 @@
+/****************************************************************************************
+ * (C) Copyright 2009-2024
+ *    Jessica Mulein <jessica@digitaldefiance.org>
+ *    Digital Defiance and Contributors <https://digitaldefiance.org>
+ *
+ * Others will be credited if more developers join.
+ *
+ * License
+ *
+ * This code is licensed under the Apache license.
+ * Please see COPYING in the root of this package for details.
+ *
+ * The following libraries are only linked in, and no code is based directly from them:
+ * htmlcxx is under the Apache 2.0 License
+ ***************************************************************************************
+ * gridiron::ViewStateField custom control class
+ * ---------------------------------------------
+ *
+ * The hidden __VIEWSTATE field. Put one in every form that posts back to the page:
+ *
+ *   <GridIron::ViewStateField auto="true" id="viewState" />
+ ***************************************************************************************/
+
+#ifndef _VIEWSTATEFIELD_HPP_
+#define _VIEWSTATEFIELD_HPP_
+
+#include <gridiron/controls/control.hpp>
+#include <string>
+#include <string_view>
+
+namespace GridIron
+{
+    namespace controls
+    {
+        class ViewStateField : public Control
+        {
+        public:
+            ViewStateField(std::string id, Control *parent);
+
+            inline static const bool AllowAutonomous() { return true; }
+
+            static constexpr std::string_view TypeName = "ViewStateField"; // <GridIron::ViewStateField>
+
+            void render(std::string &data) override; // <input type="hidden" name="__VIEWSTATE" value="..." />
+
+            inline bool RendersViewState() const override { return true; };
+
+            std::string controlTagName() const override {
+                return std::string(TypeName);
+            }
+            std::string renderTagName() const override {
+                return "input";
+            }
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,62 @@
+/****************************************************************************************
+ * (C) Copyright 2009-2024
+ *    Jessica Mulein <jessica@digitaldefiance.org>
+ *    Digital Defiance and Contributors <https://digitaldefiance.org>
+ *
+ * Others will be credited if more developers join.
+ *
+ * License
+ *
+ * This code is licensed under the Apache license.
+ * Please see COPYING in the root of this package for details.
+ *
+ * The following libraries are only linked in, and no code is based directly from them:
+ * htmlcxx is under the Apache 2.0 License
+ ***************************************************************************************
+ * FormBody Class
+ * --------------
+ *
+ * Oat++ glue: parses a posted form as the request body is read off the connection,
+ * so the body is never collected into a string first.
+ *
+ *   auto form = std::make_shared<GridIron::FormBody>();
+ *   return request->transferBodyAsync(form).next(yieldTo(&Handler::onForm));
+ *   ...
+ *   if (!form->Finish())
+ *       ... 413, the form was over the limits
+ *   page->ProcessPostBack(form->Form());
+ *
+ * Header only, so the gridiron library itself doesn't have to link against oatpp.
+ ***************************************************************************************/
+
+#ifndef _FORMBODY_HPP_
+#define _FORMBODY_HPP_
+
+#include "oatpp/core/data/stream/Stream.hpp"
+#include <gridiron/formdata.hpp>
+
+namespace GridIron
+{
+    class FormBody : public oatpp::data::stream::WriteCallback
+    {
+    public:
+        inline explicit FormBody(size_t maxBody = FormData::DefaultMaxBody) : _form(maxBody) {}
+
+        // the rest of a body over the limits is read and dropped, not failed: that would end the transfer with a
+        // generic error before the handler gets to answer 413. FormData stops keeping anything once it overflows.
+        inline oatpp::v_io_size write(const void *data, v_buff_size count, oatpp::async::Action &action) override
+        {
+            (void)action;
+            _form.Append(std::string_view(static_cast<const char *>(data), static_cast<size_t>(count)));
+            return static_cast<oatpp::v_io_size>(count);
+        }
+
+        inline bool Finish() { return _form.Finish(); }; // once the transfer is done
+        inline const FormData &Form() const { return _form; };
+
+    private:
+        FormData _form;
+    };
+}
+
+#endif
@@ -0,0 +1,96 @@
+/****************************************************************************************
+ * (C) Copyright 2009-2024
+ *    Jessica Mulein <jessica@digitaldefiance.org>
+ *    Digital Defiance and Contributors <https://digitaldefiance.org>
+ *
+ * Others will be credited if more developers join.
+ *
+ * License
+ *
+ * This code is licensed under the Apache license.
+ * Please see COPYING in the root of this package for details.
+ *
+ * The following libraries are only linked in, and no code is based directly from them:
+ * htmlcxx is under the Apache 2.0 License
+ ***************************************************************************************
+ * FormData Class
+ * --------------
+ *
+ * A posted application/x-www-form-urlencoded body, parsed as it arrives. Feed it the
+ * body in whatever pieces the connection hands over; every field that is complete is
+ * decoded right away, in place, so the body is held once and only the unfinished
+ * field at the end of a piece is ever moved. Names and values are views into that
+ * buffer, nothing is copied per field.
+ *
+ *   GridIron::FormData form;
+ *   form.Append(chunk); ...
+ *   form.Finish();
+ *   std::string_view name = form.Get("txtName");
+ ***************************************************************************************/
+
+#ifndef _FORMDATA_HPP_
+#define _FORMDATA_HPP_
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace GridIron
+{
+    class FormData
+    {
+    public:
+        static constexpr size_t DefaultMaxBody = 1 << 20; // bytes
+        static constexpr size_t MaxFields = 1000;
+
+        explicit FormData(size_t maxBody = DefaultMaxBody);
+
+        // parse the next piece of the body. false once the body is over its limits, the rest is then ignored.
+        bool Append(std::string_view chunk);
+        bool Parse(std::string body); // the whole body at once: adopted rather than copied, then finished
+        bool Finish();                // the body is complete, the last field doesn't end in '&'
+
+        inline bool Overflowed() const { return _overflowed; }; // the body went over MaxBody or MaxFields
+        inline size_t Count() const { return _fields.size(); };
+
+        // name and value of a field, in posted order. Views stay valid until the next Append.
+        std::pair<std::string_view, std::string_view> Field(size_t i) const;
+        std::string_view Get(std::string_view name, std::string_view defaultValue = std::string_view()) const; // the first with the name
+        bool Has(std::string_view name) const;
+
+        // call f(name, value) for every field, in posted order
+        template <class F>
+        void ForEach(F &&f) const
+        {
+            for (const field &entry : _fields)
+                f(std::string_view(_buffer.data() + entry.name, entry.nameLength),
+                  std::string_view(_buffer.data() + entry.value, entry.valueLength));
+        }
+
+    private:
+        // offsets rather than views, the buffer can move while the body is still arriving
+        struct field
+        {
+            size_t name;
+            size_t nameLength;
+            size_t value;
+            size_t valueLength;
+        };
+
+        void parse(bool final);                      // decode the complete fields of the pending part
+        size_t decode(size_t from, size_t to);       // decode [from, to) down to _decodedEnd, returns the decoded length
+        bool overflow();
+
+        std::string _buffer;     // decoded fields, then the undecoded rest
+        size_t _decodedEnd = 0;  // end of the decoded fields
+        size_t _scanned = 0;     // how far the pending part has been searched for '&'
+        size_t _maxBody;
+        size_t _received = 0;
+        bool _overflowed = false;
+        std::vector<field> _fields;
+    };
+}
+
+#endif
@@ -20,6 +20,7 @@
 // standard
 #include <vector>
 #include <string>
+#include <string_view>
 #include <fstream>
 
 // htmlcxx
@@ -37,25 +38,32 @@
 
 namespace GridIron
 {
-    extern const std::string HtmlNamespace;
+    // a constant, not a global std::string: templates get compiled from static initializers (see templatec.cpp),
+    // which can run before a string defined in the library would be
+    inline constexpr std::string_view HtmlNamespace = GRIDIRON_XHTML_NS;
 
     class Control;
 
     // htmlnode
     typedef htmlcxx::HTML::Node htmlnode;
 
-    // parse/find control type in <GridIron::XType ...>
-    std::pair<std::string, std::string> gridironParseTag(std::string tag);
+    // parse/find namespace and control type in <GridIron::XType ...> (or GridIron::XType). Views into tag, both empty if it isn't one.
+    std::pair<std::string_view, std::string_view> gridironParseTag(std::string_view tag);
 
-    std::string getGridIronCustomControlName(std::string tag);
+    std::string_view getGridIronCustomControlName(std::string_view tag); // XType if the namespace is ours, else empty
 
-    bool isCustomControl(std::string tag);
+    bool isCustomControl(std::string_view tag);
 
-    std::ostream &xmlEncode(std::string &data, std::ostream &os);
+    // xml entity encoding of & " ' < >. See xmlencode.cpp
+    size_t xmlEncodedLength(std::string_view data); // size of data once encoded
+
+    std::string &xmlEncode(std::string_view data, std::string &out); // append encoded data to out, growing it once
+
+    std::ostream &xmlEncode(std::string_view data, std::ostream &os);
 
     std::ostream &xmlEncode(std::ostream &dest, std::istream &source);
 
-    std::string xmlEncode(std::string data);
+    std::string xmlEncode(std::string_view data);
 }
 
 #endif
@@ -0,0 +1,60 @@
+/****************************************************************************************
+ * (C) Copyright 2009-2024
+ *    Jessica Mulein <jessica@digitaldefiance.org>
+ *    Digital Defiance and Contributors <https://digitaldefiance.org>
+ *
+ * Others will be credited if more developers join.
+ *
+ * License
+ *
+ * This code is licensed under the Apache license.
+ * Please see COPYING in the root of this package for details.
+ *
+ * The following libraries are only linked in, and no code is based directly from them:
+ * htmlcxx is under the Apache 2.0 License
+ ***************************************************************************************
+ * SHA-256 / HMAC-SHA256
+ * ---------------------
+ *
+ * Just enough hashing to authenticate the ViewState, without pulling in a crypto library.
+ * FIPS 180-4 and RFC 2104.
+ ***************************************************************************************/
+
+#ifndef _HMAC_HPP_
+#define _HMAC_HPP_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace GridIron
+{
+    typedef std::array<uint8_t, 32> sha256_digest;
+
+    class Sha256
+    {
+    public:
+        static constexpr size_t BlockSize = 64;
+
+        Sha256();
+        void Update(const void *data, size_t length);
+        inline void Update(std::string_view data) { Update(data.data(), data.size()); };
+        sha256_digest Final(); // the hasher can't be updated afterwards
+
+    private:
+        void block(const uint8_t *data);
+
+        uint32_t _state[8];
+        uint8_t _buffer[BlockSize];
+        size_t _buffered = 0;
+        uint64_t _length = 0; // bytes hashed so far
+    };
+
+    sha256_digest HmacSha256(std::string_view key, std::string_view data);
+
+    // compares all of both, however early they differ, so timing doesn't give away how much of a MAC was right
+    bool ConstantTimeEquals(const uint8_t *a, const uint8_t *b, size_t length);
+}
+
+#endif
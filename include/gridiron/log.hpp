@@ -0,0 +1,178 @@
+/****************************************************************************************
+ * (C) Copyright 2009-2024
+ *    Jessica Mulein <jessica@digitaldefiance.org>
+ *    Digital Defiance and Contributors <https://digitaldefiance.org>
+ *
+ * Others will be credited if more developers join.
+ *
+ * License
+ *
+ * This code is licensed under the Apache license.
+ * Please see COPYING in the root of this package for details.
+ *
+ * The following libraries are only linked in, and no code is based directly from them:
+ * htmlcxx is under the Apache 2.0 License
+ ***************************************************************************************
+ * Logger Class
+ * ------------
+ *
+ * Leveled logging that is safe to leave in the render path.
+ *
+ * Levels below GRIDIRON_LOG_LEVEL are compiled out entirely (arguments included).
+ * Anything else is formatted into a fixed size record and pushed onto a ring buffer
+ * owned by the calling thread: no locks, no allocation, no I/O. A background thread
+ * drains all the rings and writes to the sink. If a ring is full the record is
+ * dropped and counted rather than blocking the request.
+ *
+ *   GRIDIRON_LOG_DEBUG("bound control ", id, " to slot ", slot);
+ ***************************************************************************************/
+
+#ifndef _LOG_HPP_
+#define _LOG_HPP_
+
+#include <atomic>
+#include <charconv>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// 0 trace, 1 debug, 2 info, 3 warn, 4 error, 5 off
+#ifndef GRIDIRON_LOG_LEVEL
+#define GRIDIRON_LOG_LEVEL 2
+#endif
+
+namespace GridIron
+{
+    enum class LogLevel : int
+    {
+        Trace = 0,
+        Debug = 1,
+        Info = 2,
+        Warn = 3,
+        Error = 4,
+        Off = 5
+    };
+
+    constexpr LogLevel CompiledLogLevel = static_cast<LogLevel>(GRIDIRON_LOG_LEVEL);
+
+    const char *LogLevelName(LogLevel level);
+
+    // one formatted message, fixed size so rings never allocate
+    struct LogRecord
+    {
+        static constexpr size_t MaxText = 232; // longer messages are truncated
+
+        uint64_t time;   // nanoseconds, steady clock
+        LogLevel level;
+        uint16_t length;
+        char text[MaxText];
+
+        void append(std::string_view value);
+        void append(const char *value) { append(std::string_view(value != nullptr ? value : "(null)")); }
+        void append(const std::string &value) { append(std::string_view(value)); }
+        void append(char value) { append(std::string_view(&value, 1)); }
+        void append(bool value) { append(value ? std::string_view("true") : std::string_view("false")); }
+        void append(const void *value);
+
+        template <class T, std::enable_if_t<std::is_integral_v<T>, int> = 0>
+        void append(T value)
+        {
+            char digits[24];
+            auto result = std::to_chars(digits, digits + sizeof(digits), value);
+            append(std::string_view(digits, result.ptr - digits));
+        }
+    };
+
+    // single producer (the owning thread), single consumer (the drain thread)
+    class LogRing
+    {
+    public:
+        static constexpr size_t Capacity = 256; // power of two
+
+        bool Push(const LogRecord &record); // false if full
+        bool Pop(LogRecord &record);        // false if empty
+        inline bool Empty() const { return _tail.load(std::memory_order_acquire) == _head.load(std::memory_order_acquire); };
+
+    private:
+        LogRecord _records[Capacity];
+        alignas(64) std::atomic<size_t> _head{0}; // next to write, owned by the producer
+        alignas(64) std::atomic<size_t> _tail{0}; // next to read, owned by the consumer
+    };
+
+    class Logger
+    {
+    public:
+        static Logger &Instance(); // created on first use, starts the drain thread
+
+        ~Logger();
+        Logger(const Logger &) = delete;
+        Logger &operator=(const Logger &) = delete;
+
+        // runtime filter on top of the compiled one
+        inline void SetLevel(LogLevel level) { _level.store(level, std::memory_order_relaxed); };
+        inline LogLevel GetLevel() const { return _level.load(std::memory_order_relaxed); };
+        inline bool Enabled(LogLevel level) const { return level >= GetLevel(); };
+
+        void SetSink(std::ostream *sink); // where drained records go, std::cerr by default. nullptr discards them.
+        void Flush();                     // drain everything logged so far, now, on the calling thread
+
+        inline uint64_t Dropped() const { return _dropped.load(std::memory_order_relaxed); }; // records lost to full rings
+
+        template <class... Args>
+        void Write(LogLevel level, const Args &...args)
+        {
+            if (!Enabled(level))
+                return;
+            LogRecord record;
+            record.level = level;
+            record.length = 0;
+            (record.append(args), ...);
+            push(record);
+        }
+
+    private:
+        Logger();
+
+        void push(LogRecord &record);
+        LogRing &ring(); // the calling thread's
+        void drain();    // caller holds _drainLock
+        void run();
+
+        std::atomic<LogLevel> _level{CompiledLogLevel};
+        std::atomic<uint64_t> _dropped{0};
+
+        std::mutex _ringsLock; // only taken when a thread logs for the first time, and by the drain thread
+        std::vector<std::shared_ptr<LogRing>> _rings;
+
+        std::mutex _drainLock; // drain thread vs Flush, never taken by producers
+        std::ostream *_sink;
+        std::string _batch; // formatted output of one drain
+
+        std::mutex _wakeLock;
+        std::condition_variable _wake;
+        bool _stopping = false;
+        std::thread _thread;
+    };
+}
+
+#define GRIDIRON_LOG(level, ...)                                                \
+    do                                                                          \
+    {                                                                           \
+        if constexpr ((level) >= ::GridIron::CompiledLogLevel)                  \
+            ::GridIron::Logger::Instance().Write((level), __VA_ARGS__);         \
+    } while (0)
+
+#define GRIDIRON_LOG_TRACE(...) GRIDIRON_LOG(::GridIron::LogLevel::Trace, __VA_ARGS__)
+#define GRIDIRON_LOG_DEBUG(...) GRIDIRON_LOG(::GridIron::LogLevel::Debug, __VA_ARGS__)
+#define GRIDIRON_LOG_INFO(...) GRIDIRON_LOG(::GridIron::LogLevel::Info, __VA_ARGS__)
+#define GRIDIRON_LOG_WARN(...) GRIDIRON_LOG(::GridIron::LogLevel::Warn, __VA_ARGS__)
+#define GRIDIRON_LOG_ERROR(...) GRIDIRON_LOG(::GridIron::LogLevel::Error, __VA_ARGS__)
+
+#endif
@@ -0,0 +1,104 @@
+/****************************************************************************************
+ * (C) Copyright 2009-2024
+ *    Jessica Mulein <jessica@digitaldefiance.org>
+ *    Digital Defiance and Contributors <https://digitaldefiance.org>
+ *
+ * Others will be credited if more developers join.
+ *
+ * License
+ *
+ * This code is licensed under the Apache license.
+ * Please see COPYING in the root of this package for details.
+ *
+ * The following libraries are only linked in, and no code is based directly from them:
+ * htmlcxx is under the Apache 2.0 License
+ ***************************************************************************************
+ * OutputCache Class
+ * -----------------
+ *
+ * Keeps rendered html of whole pages, or of single controls, for reuse by later requests.
+ * Opt in per page or per control with an OutputCachePolicy:
+ *
+ *   page->SetOutputCache({std::chrono::minutes(2), {"lblTest.Text"}, {"lang"}});
+ *
+ * Entries expire after the policy's duration and are keyed by the front page, the
+ * control's id and the current values of the vary-by variables and query parameters.
+ * The cache holds to a memory budget, evicting least recently used entries first. It
+ * is split into shards, each with its own lock, so requests rarely wait on each other.
+ ***************************************************************************************/
+
+#ifndef _OUTPUTCACHE_HPP_
+#define _OUTPUTCACHE_HPP_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace GridIron
+{
+    struct OutputCachePolicy
+    {
+        std::chrono::milliseconds duration{0};    // how long a rendering is reused, 0 turns caching off
+        std::vector<std::string> varyByVariables; // page variables whose values pick the cached copy
+        std::vector<std::string> varyByParams;    // query parameters whose values pick the cached copy
+    };
+
+    class OutputCache
+    {
+    public:
+        static constexpr size_t ShardCount = 16;                   // power of two
+        static constexpr size_t DefaultBudget = 64 * 1024 * 1024; // bytes, across all shards
+
+        static OutputCache &Instance(); // process-wide cache
+
+        std::shared_ptr<const std::string> Get(const std::string &key); // nullptr if missing or expired
+        void Put(const std::string &key, std::shared_ptr<const std::string> output, std::chrono::milliseconds duration);
+        void Invalidate(const std::string &key);
+        void Clear();
+
+        void SetBudget(size_t bytes); // evicts right away if over the new budget
+        inline size_t Budget() const { return _budget.load(std::memory_order_relaxed); };
+        size_t Size();                // bytes currently held
+
+        inline uint64_t Hits() const { return _hits.load(std::memory_order_relaxed); };
+        inline uint64_t Misses() const { return _misses.load(std::memory_order_relaxed); };
+
+    private:
+        OutputCache() = default;
+
+        struct Entry
+        {
+            std::string key;
+            std::shared_ptr<const std::string> output; // readers keep their copy alive past eviction
+            std::chrono::steady_clock::time_point expires;
+            size_t cost; // bytes charged to the budget
+        };
+
+        struct Shard
+        {
+            std::mutex lock;
+            std::list<Entry> lru;                                                    // most recently used first
+            std::unordered_map<std::string_view, std::list<Entry>::iterator> index; // keys point into the entries
+            size_t bytes = 0;
+        };
+
+        Shard &shard(const std::string &key);
+        void erase(Shard &shard, std::list<Entry>::iterator entry); // caller holds the shard's lock
+        void evict(Shard &shard);                                   // down to the shard's share of the budget, same
+
+        std::array<Shard, ShardCount> _shards;
+        std::atomic<size_t> _budget{DefaultBudget};
+        std::atomic<uint64_t> _hits{0};
+        std::atomic<uint64_t> _misses{0};
+    };
+}
+
+#endif
@@ -0,0 +1,96 @@
+/****************************************************************************************
+ * (C) Copyright 2009-2024
+ *    Jessica Mulein <jessica@digitaldefiance.org>
+ *    Digital Defiance and Contributors <https://digitaldefiance.org>
+ *
+ * Others will be credited if more developers join.
+ *
+ * License
+ *
+ * This code is licensed under the Apache license.
+ * Please see COPYING in the root of this package for details.
+ *
+ * The following libraries are only linked in, and no code is based directly from them:
+ * htmlcxx is under the Apache 2.0 License
+ ***************************************************************************************
+ * PageBody Class
+ * --------------
+ *
+ * Oat++ glue: streams a Page into a response body as it renders. Wrap it in a
+ * StreamingBody and the page goes out chunked, straight from the template into the
+ * connection's buffer, without ever being assembled into one string.
+ *
+ *   auto body = std::make_shared<oatpp::web::protocol::http::outgoing::StreamingBody>(
+ *       std::make_shared<GridIron::PageBody>(page));
+ *   auto response = OutgoingResponse::createShared(Status::CODE_200, body);
+ *
+ * Controls that wait on data (see Control::ReadyToRender) don't hold up the thread:
+ * everything before such a control goes out, then the read tells the coroutine to
+ * wait, on a wait list the page's ready listener wakes. Pass async = false for a
+ * synchronous endpoint, where the read blocks instead.
+ *
+ * Header only, so the gridiron library itself doesn't have to link against oatpp.
+ ***************************************************************************************/
+
+#ifndef _PAGEBODY_HPP_
+#define _PAGEBODY_HPP_
+
+#include <chrono>
+#include <memory>
+#include "oatpp/core/async/CoroutineWaitList.hpp"
+#include "oatpp/core/data/stream/Stream.hpp"
+#include <gridiron/controls/page.hpp>
+
+namespace GridIron
+{
+    class PageBody : public oatpp::data::stream::ReadCallback
+    {
+    public:
+        // a wake up can slip in between a read finding a control not ready and the coroutine starting to wait,
+        // so waits are capped and the control is looked at again
+        static constexpr std::chrono::milliseconds RecheckInterval{20};
+
+        inline PageBody(std::shared_ptr<Page> page, bool async = true) : _reader(std::move(page)), _async(async)
+        {
+            if (_async)
+                _reader.GetPage()->SetReadyListener([this]
+                                                    { _waitList.notifyAll(); });
+        }
+
+        // the page can outlive us, it mustn't call into a wait list that's gone
+        inline ~PageBody()
+        {
+            if (_async)
+                _reader.GetPage()->SetReadyListener(nullptr);
+        }
+
+        // returning 0 tells oatpp the body is complete
+        inline oatpp::v_io_size read(void *buffer, v_buff_size count, oatpp::async::Action &action) override
+        {
+            size_t n = _reader.Read(static_cast<char *>(buffer), static_cast<size_t>(count));
+            if (n == 0 && _reader.Waiting())
+            {
+                if (_async)
+                {
+                    action = oatpp::async::Action::createWaitListActionWithTimeout(
+                        &_waitList, std::chrono::steady_clock::now() + RecheckInterval);
+                    return oatpp::IOError::RETRY_READ;
+                }
+                // a control can render to nothing, so keep going until something comes out or the page is done
+                do
+                {
+                    _reader.Wait();
+                    n = _reader.Read(static_cast<char *>(buffer), static_cast<size_t>(count));
+                } while (n == 0 && _reader.Waiting());
+            }
+            return static_cast<oatpp::v_io_size>(n);
+        }
+
+    private:
+        PageReader _reader;
+        bool _async;
+        oatpp::async::CoroutineWaitList _waitList;
+    };
+}
+
+#endif
@@ -0,0 +1,110 @@
+/****************************************************************************************
+ * (C) Copyright 2009-2024
+ *    Jessica Mulein <jessica@digitaldefiance.org>
+ *    Digital Defiance and Contributors <https://digitaldefiance.org>
+ *
+ * Others will be credited if more developers join.
+ *
+ * License
+ *
+ * This code is licensed under the Apache license.
+ * Please see COPYING in the root of this package for details.
+ *
+ * The following libraries are only linked in, and no code is based directly from them:
+ * htmlcxx is under the Apache 2.0 License
+ ***************************************************************************************
+ * RenderBuffer Class
+ * ------------------
+ *
+ * Strings to render into that are kept per thread and reused across requests, so
+ * building output doesn't allocate once the buffers have grown to the usual page
+ * size. Paired with a SizeEstimate, a running average of how big some output tends
+ * to be, a buffer can be reserved once up front rather than regrown as it fills:
+ *
+ *   GridIron::RenderBuffer buffer(estimate.Predict());
+ *   page.render(buffer.String());
+ *   estimate.Record(buffer.Size());
+ *
+ * Buffers nest: each RenderBuffer alive on a thread has a string of its own.
+ ***************************************************************************************/
+
+#ifndef _RENDERBUFFER_HPP_
+#define _RENDERBUFFER_HPP_
+
+#include <atomic>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace GridIron
+{
+    template <class T>
+    inline constexpr bool isDecimalInteger = std::is_integral_v<T> && !std::is_same_v<T, bool> && !std::is_same_v<T, char>;
+
+    // append the decimal digits of value (any integer type but bool and char), without a temporary string
+    template <class T, std::enable_if_t<isDecimalInteger<T>, int> = 0>
+    inline std::string &appendInteger(std::string &out, T value)
+    {
+        char digits[24];
+        const std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), value);
+        return out.append(digits, static_cast<size_t>(result.ptr - digits));
+    }
+
+    // exponential moving average of output sizes, new sizes weigh 1/8. Lock free, concurrent
+    // renders may lose a sample now and then, which is fine for an estimate.
+    class SizeEstimate
+    {
+    public:
+        void Record(size_t size);
+        inline size_t Predict() const // with some headroom, 0 until something is recorded
+        {
+            const size_t estimate = _estimate.load(std::memory_order_relaxed);
+            return estimate + estimate / 8;
+        };
+
+    private:
+        std::atomic<size_t> _estimate{0};
+    };
+
+    class RenderBuffer
+    {
+    public:
+        static constexpr size_t PoolSize = 4;         // buffers kept per thread
+        static constexpr size_t MaxRetained = 1 << 22; // a buffer grown past this is freed rather than kept
+
+        explicit RenderBuffer(size_t expected = 0); // empty, with at least expected bytes reserved
+        ~RenderBuffer();                            // goes back to the thread's pool
+        RenderBuffer(const RenderBuffer &) = delete;
+        RenderBuffer &operator=(const RenderBuffer &) = delete;
+
+        inline std::string &String() { return _data; };
+        inline const std::string &String() const { return _data; };
+        inline size_t Size() const { return _data.size(); };
+        inline std::string_view View() const { return _data; };
+
+        inline RenderBuffer &Append(std::string_view text)
+        {
+            _data.append(text.data(), text.size());
+            return *this;
+        };
+        inline RenderBuffer &Append(char c)
+        {
+            _data.push_back(c);
+            return *this;
+        };
+        template <class T, std::enable_if_t<isDecimalInteger<T>, int> = 0>
+        inline RenderBuffer &Append(T value) // in decimal
+        {
+            appendInteger(_data, value);
+            return *this;
+        };
+
+    private:
+        std::string _data;
+    };
+}
+
+#endif
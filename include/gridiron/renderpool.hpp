@@ -0,0 +1,109 @@
+/****************************************************************************************
+ * (C) Copyright 2009-2024
+ *    Jessica Mulein <jessica@digitaldefiance.org>
+ *    Digital Defiance and Contributors <https://digitaldefiance.org>
+ *
+ * Others will be credited if more developers join.
+ *
+ * License
+ *
+ * This code is licensed under the Apache license.
+ * Please see COPYING in the root of this package for details.
+ *
+ * The following libraries are only linked in, and no code is based directly from them:
+ * htmlcxx is under the Apache 2.0 License
+ ***************************************************************************************
+ * RenderPool Class
+ * ----------------
+ *
+ * Worker threads for rendering independent controls of a page at the same time.
+ * Fork/join: ForEach hands out the indices of a batch one at a time to whichever
+ * thread is free, the calling thread included, and returns once they're all done.
+ * Since the caller works through the batch too, a task may start a batch of its own
+ * without waiting on threads that are waiting on it.
+ *
+ * Start hands a batch to the workers and returns straight away, for a caller that has
+ * other things to do meanwhile (a PageReader streaming out what comes before).
+ ***************************************************************************************/
+
+#ifndef _RENDERPOOL_HPP_
+#define _RENDERPOOL_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace GridIron
+{
+    class RenderPool
+    {
+    public:
+        static RenderPool &Instance(); // created on first use, with a worker per core but one (the caller's)
+
+        RenderPool(size_t threads);
+        ~RenderPool(); // finishes queued batches, then stops the workers
+        RenderPool(const RenderPool &) = delete;
+        RenderPool &operator=(const RenderPool &) = delete;
+
+        // run task(i) for every i in [0, count) and wait for all of them. The first exception a task throws is
+        // rethrown here, once the rest of the batch is done.
+        void ForEach(size_t count, const std::function<void(size_t)> &task);
+
+        inline size_t Threads() const { return _workers.size(); };
+
+    private:
+        struct batch
+        {
+            const std::function<void(size_t)> *task;
+            std::function<void(size_t)> owned; // the task, for a started batch
+            size_t count;
+            std::atomic<size_t> next{0};    // next index to hand out
+            std::atomic<size_t> pending{0}; // indices not finished yet
+            std::mutex lock;                // done and error
+            std::condition_variable done;
+            std::exception_ptr error;
+        };
+
+        void run();                    // worker thread
+        void work(batch &job);         // take indices of job until there are none left
+        void finished(batch &job);     // one index of job is done
+
+        static void wait(batch &job, bool rethrow); // until every index of job is done, then rethrow its error if asked
+
+    public:
+        // a started batch. Wait on it (destroying it waits too) before anything its tasks use goes away.
+        class Started
+        {
+        public:
+            Started() = default;
+            Started(Started &&) = default;
+            Started &operator=(Started &&other);
+            ~Started();
+
+            void Wait(); // block until every task has finished, rethrowing the first exception one threw
+
+        private:
+            friend class RenderPool;
+            std::shared_ptr<batch> _job;
+        };
+
+        // run task(i) for every i in [0, count) on the workers, without waiting. With no workers it runs here and now.
+        Started Start(size_t count, std::function<void(size_t)> task);
+
+    private:
+        std::vector<std::thread> _workers;
+        std::deque<std::shared_ptr<batch>> _queue; // batches with indices left to hand out
+        std::mutex _lock;
+        std::condition_variable _wake;
+        bool _stopping = false;
+    };
+}
+
+#endif
@@ -1,33 +1,63 @@
 #ifndef GRIDIRON_TAG_HPP
 #define GRIDIRON_TAG_HPP
 
-#include <string>
-#include <map>
+#include <cstddef>
+#include <initializer_list>
 #include <iostream>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 namespace GridIron
 {
+    // an html tag with its attributes, kept in the order they were set.
+    // attributes live in a small buffer inside the tag, spilling over to upstream (e.g. a page's Arena::Resource())
+    // once that's full, so a typical tag never touches the heap.
     class Tag
     {
     public:
-        Tag(std::string tag);
-        Tag(std::string tag, std::string contents);
-        Tag(std::string tag, std::string contents, std::map<const char *, const char *> attributes);
-        Tag(std::string tag, std::map<const char *, const char *> attributes);
+        struct Attribute
+        {
+            std::pmr::string name;
+            std::pmr::string value;
+            bool hasValue; // false for bare attributes like <input disabled>
+        };
+        typedef std::pmr::vector<Attribute> attribute_list;
+        typedef std::initializer_list<std::pair<std::string_view, std::string_view>> attribute_init;
+
+        explicit Tag(std::string_view tag, std::pmr::memory_resource *upstream = std::pmr::get_default_resource());
+        Tag(std::string_view tag, std::string_view contents, std::pmr::memory_resource *upstream = std::pmr::get_default_resource());
+        Tag(std::string_view tag, std::string_view contents, attribute_init attributes,
+            std::pmr::memory_resource *upstream = std::pmr::get_default_resource());
+        Tag(std::string_view tag, attribute_init attributes, std::pmr::memory_resource *upstream = std::pmr::get_default_resource());
+        Tag(const Tag &) = delete; // the attributes point into this instance
+        Tag &operator=(const Tag &) = delete;
 
-        void setAttribute(const char *attribute, const char *value);
-        void setAttribute(std::string attribute, std::string value);
+        void setAttribute(std::string_view attribute, std::string_view value); // replaces in place if already set
+        void setAttribute(std::string_view attribute);                         // bare attribute, no value
 
-        std::string tagName();
-        std::map<const char *, const char *> attributes();
-        const char *attribute(const char *key, const char *defaultValue);
+        inline std::string_view tagName() const { return _tagName; };
+        inline std::string_view contents() const { return _contents; };
+        inline const attribute_list &attributes() const { return _attributes; }; // insertion order
+        std::string_view attribute(std::string_view key, std::string_view defaultValue = std::string_view()) const;
 
-        friend std::ostream &operator<<(std::ostream &os, Tag &tag);
+        std::string &render(std::string &data) const; // append the tag to data, growing it once
+        size_t renderedLength() const;                // what render will append
+
+        friend std::ostream &operator<<(std::ostream &os, const Tag &tag);
 
     protected:
-        const std::string _tagName;
-        const std::string _contents;
-        std::map<const char *, const char *> _attributes;
+        Attribute *find(std::string_view key);
+
+        static constexpr size_t InlineBytes = 512; // a handful of attributes with short values
+
+        alignas(std::max_align_t) std::byte _inline[InlineBytes];
+        std::pmr::monotonic_buffer_resource _resource; // replaced values aren't reclaimed until the tag goes
+        const std::pmr::string _tagName;
+        const std::pmr::string _contents;
+        attribute_list _attributes;
     };
 }
 
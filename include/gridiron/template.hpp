@@ -0,0 +1,245 @@
+/****************************************************************************************
+ * (C) Copyright 2009-2024
+ *    Jessica Mulein <jessica@digitaldefiance.org>
+ *    Digital Defiance and Contributors <https://digitaldefiance.org>
+ *
+ * Others will be credited if more developers join.
+ *
+ * License
+ *
+ * This code is licensed under the Apache license.
+ * Please see COPYING in the root of this package for details.
+ *
+ * The following libraries are only linked in, and no code is based directly from them:
+ * htmlcxx is under the Apache 2.0 License
+ ***************************************************************************************
+ * Template / TemplateCache Classes
+ * --------------------------------
+ *
+ * A Template is the loaded and parsed form of a front page. It is immutable once
+ * constructed, so a single instance is shared by every Page rendering that file.
+ *
+ * At load time the tree is also compiled into a flat render plan: a list of literal
+ * byte ranges (adjacent static html coalesced into one span) interleaved with
+ * control and variable slots. Rendering a page is a linear pass over that list.
+ *
+ * The TemplateCache hands out those shared instances, keyed by the resolved path,
+ * so the file is read and parsed once per process instead of once per request.
+ ***************************************************************************************/
+
+#ifndef _TEMPLATE_HPP_
+#define _TEMPLATE_HPP_
+
+#include <gridiron/gridiron.hpp>
+#include <gridiron/tokenizer.hpp>
+#include <gridiron/renderbuffer.hpp>
+#include <atomic>
+#include <deque>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace GridIron
+{
+    enum class RenderOpType
+    {
+        Literal, // emit text as-is
+        Control, // render the control bound to slot
+        Value,   // emit the variable bound to slot
+        Flush    // emit nothing, a streaming reader sends what it has so far (<GridIron::Flush />)
+    };
+
+    // one instruction of a compiled template
+    struct RenderOp
+    {
+        RenderOpType type;
+        std::string_view text; // Literal: points into the template data (or a rewritten tag), never copied
+        size_t slot;           // Control/Value: index into the page's slot arrays
+    };
+
+    // a read-only run of items, kept by the Template or by constants gridiron-templatec generated
+    template <typename T>
+    class ConstArray
+    {
+    public:
+        ConstArray() : _items(nullptr), _count(0) {}
+        ConstArray(const T *items, size_t count) : _items(items), _count(count) {}
+
+        inline size_t size() const { return _count; };
+        inline bool empty() const { return _count == 0; };
+        inline const T *data() const { return _items; };
+        inline const T &operator[](size_t i) const { return _items[i]; };
+        inline const T *begin() const { return _items; };
+        inline const T *end() const { return _items + _count; };
+
+    private:
+        const T *_items;
+        size_t _count;
+    };
+
+    typedef ConstArray<RenderOp> render_plan;
+
+    // where a control tag's element is. Offsets are into the template data.
+    struct PrecompiledControl
+    {
+        std::string_view tagName;
+        size_t offset;        // start of the opening tag
+        size_t length;        // the whole element, closing tag included
+        size_t textLength;    // the opening tag
+        size_t closingLength; // the closing tag, 0 if there isn't one
+    };
+
+    // a control tag of the page, indexed once when the template is compiled so binding never goes back to the html.
+    // Everything points into the template data, so gridiron-templatec can emit these as constants too.
+    struct ControlTag
+    {
+        std::string_view id;   // empty if the tag has none
+        std::string_view type; // control type, e.g. "Label" for <GridIron::Label>
+        bool autonomous;       // auto="true", the page creates the control itself
+        const tag_attribute *attributes; // name, value
+        size_t attributeCount;
+
+        std::string_view Attribute(std::string_view name) const; // value of an attribute, empty if the tag doesn't have it
+    };
+
+    // a front page compiled at build time by gridiron-templatec. The generated source defines one of these
+    // as a constant, pointing at constexpr arrays. The Template made from it uses the html, the plan and the
+    // control index where they are; at startup it only builds the variable name lookup. A control's htmlnode
+    // is still made from the recorded offsets, the first time a page binds that control.
+    struct PrecompiledTemplate
+    {
+        std::string_view path; // front page, relative to the docroot
+        std::string_view data; // the html
+        const RenderOp *plan;
+        size_t planSize;
+        const PrecompiledControl *controls; // controlCount of them, and of tags
+        const ControlTag *tags;
+        size_t controlCount;
+        const std::string_view *valueKeys;
+        size_t valueCount;
+    };
+
+    class Template;
+
+    // output of a control that only depends on its tag, built once by the first page that needs it and then
+    // shared by every page rendering the template (see Label)
+    struct StaticFragments
+    {
+        std::string prefix; // e.g. the opening tag, with the control's defaults
+        std::string body;   // e.g. the default contents, already encoded
+    };
+
+    typedef void (*fragment_builder)(const Template &compiled, size_t slot, StaticFragments &fragments);
+
+    class Template
+    {
+    public:
+        Template(std::string path, std::string data); // parse the given html, path is informational only
+        explicit Template(const PrecompiledTemplate &compiled); // use a build-time compiled page in place, no parsing
+        Template(const Template &) = delete;            // the plan and slots point into this instance
+        Template &operator=(const Template &) = delete;
+
+        static std::shared_ptr<const Template> FromFile(const std::string &fullPath); // read and parse a file
+
+        inline const std::string &Path() const { return _path; };         // resolved path of the front page
+        inline std::string_view Data() const { return _data; };           // raw front page html
+        inline render_plan Plan() const { return _plan; };                // compiled render instructions
+
+        inline size_t ControlCount() const { return _controls.size(); };     // number of control slots
+        inline size_t ValueCount() const { return _valueKeys.size(); };      // number of variable slots
+        inline const std::string &ValueKey(size_t slot) const { return _valueKeys[slot]; };
+        size_t ValueSlot(const std::string &name) const; // slot of a variable name, npos if no Value tag uses it
+
+        inline SizeEstimate &OutputSize() const { return _outputSize; }; // how big pages rendered from us come out
+        const htmlnode &ControlNode(size_t slot) const; // tag of a control slot, made on first use
+        inline ConstArray<ControlTag> Controls() const { return _controlTags; }; // control index, by slot
+        // a control slot's static output, built on first use. A slot has one builder: the first one asked wins.
+        const StaticFragments &Fragments(size_t slot, fragment_builder build) const;
+
+        static constexpr size_t npos = static_cast<size_t>(-1);
+
+    private:
+        void compile(HtmlTokenizer &tokenizer, size_t &cursor);
+        void emitLiteral(std::string_view text);
+        void emitLiteral(size_t from, size_t to);
+        size_t indexControl(std::string_view tagName, size_t offset, size_t length, size_t textLength,
+                            size_t closingLength); // give a control tag the next slot
+
+        const std::string _path;
+        const std::string _source;    // the html if we compiled it ourselves, empty for a precompiled page
+        const std::string_view _data; // _source, or the constant gridiron-templatec generated
+
+        // what compile builds. A precompiled page has all this as constants and leaves them empty.
+        std::vector<RenderOp> _ops;
+        std::list<std::string> _rewritten;                // tags we output differently than written (stable addresses)
+        std::vector<PrecompiledControl> _elements;
+        std::vector<ControlTag> _tags;
+        std::deque<std::vector<tag_attribute>> _attributes; // of each control tag, a deque so they never move
+
+        render_plan _plan;                                // _ops, or the generated plan
+        ConstArray<PrecompiledControl> _controls;         // control slot -> where its element is
+        ConstArray<ControlTag> _controlTags;              // control slot -> id, type and attributes
+        std::vector<std::string> _valueKeys;              // value slot -> variable name
+        std::unordered_map<std::string, size_t> _valueSlots; // variable name -> value slot
+        struct nodeSlot
+        {
+            std::once_flag built;
+            htmlnode node;
+        };
+        mutable std::deque<nodeSlot> _nodes;                 // control slot -> tag for fromHtmlNode, made on first use
+        struct fragmentSlot
+        {
+            std::once_flag built;
+            StaticFragments fragments;
+        };
+        mutable std::deque<fragmentSlot> _fragments;         // control slot -> static output, a deque so it never moves
+        mutable SizeEstimate _outputSize;                    // updated by every page render, the template stays shared read-only
+    };
+
+    class TemplateCache
+    {
+    public:
+        static TemplateCache &Instance(); // process-wide cache
+
+        // return the compiled template for a front page (relative to the docroot), loading it on first use
+        std::shared_ptr<const Template> Get(const std::string &frontPage);
+
+        // serve a template for a front page without reading the file, e.g. one compiled in by gridiron-templatec
+        void Preload(const std::string &frontPage, std::shared_ptr<const Template> compiled);
+
+        void Invalidate(const std::string &frontPage); // drop one entry, next Get reloads it
+        void Clear();                                  // drop everything
+
+        // recompile cached front pages in the background when their files change, so template changes can be
+        // deployed without a restart. Pages already rendering keep the version they started with.
+        // false if the platform has no file watching (only Linux/inotify for now)
+        bool Watch();
+        void Unwatch();
+
+        ~TemplateCache();
+
+    private:
+        TemplateCache();
+
+        void watchDirectory(const std::string &fullPath); // caller holds _lock exclusively
+        void watchLoop();
+        void reload(const std::string &fullPath);
+
+        std::shared_mutex _lock;
+        std::map<std::string, std::shared_ptr<const Template>> _templates; // by resolved path
+
+        int _inotify = -1;                       // watcher fd, -1 when not watching
+        std::map<int, std::string> _watchedDirs; // watch descriptor -> directory, guarded by _lock
+        std::atomic<bool> _watching{false};
+        std::thread _watcher;
+    };
+}
+
+#endif
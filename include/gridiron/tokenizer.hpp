@@ -0,0 +1,85 @@
+/****************************************************************************************
+ * (C) Copyright 2009-2024
+ *    Jessica Mulein <jessica@digitaldefiance.org>
+ *    Digital Defiance and Contributors <https://digitaldefiance.org>
+ *
+ * Others will be credited if more developers join.
+ *
+ * License
+ *
+ * This code is licensed under the Apache license.
+ * Please see COPYING in the root of this package for details.
+ *
+ * The following libraries are only linked in, and no code is based directly from them:
+ * htmlcxx is under the Apache 2.0 License
+ ***************************************************************************************
+ * HtmlTokenizer Class
+ * -------------------
+ *
+ * Streams through a front page once, handing out only what the template compiler cares
+ * about: <Namespace::Type ...> tags of one namespace (opening, closing or self-closing,
+ * with views of their attributes) and the literal spans between them. Everything else,
+ * ordinary tags, comments, doctype, script and style contents, is part of a literal.
+ *
+ * Nothing is copied: every view points into the buffer being scanned, which must
+ * outlive the tokens. Nothing is built either, it is one forward scan with no tree.
+ ***************************************************************************************/
+
+#ifndef _TOKENIZER_HPP_
+#define _TOKENIZER_HPP_
+
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace GridIron
+{
+    enum class HtmlTokenType
+    {
+        Literal,    // text between our tags, ordinary html included
+        Open,       // <Namespace::Type ...>
+        Close,      // </Namespace::Type>
+        SelfClosing // <Namespace::Type ... />
+    };
+
+    typedef std::pair<std::string_view, std::string_view> tag_attribute; // name, value (as written, quotes removed)
+
+    struct HtmlToken
+    {
+        HtmlTokenType type;
+        std::string_view text;      // the whole token
+        size_t offset;              // of text in the scanned buffer
+        std::string_view name;      // tags: Namespace::Type
+        std::string_view ns;        // tags: Namespace
+        std::string_view tagType;   // tags: Type
+        std::vector<tag_attribute> attributes; // Open/SelfClosing, reused from token to token
+
+        std::string_view Attribute(std::string_view attributeName) const; // value, empty if the tag doesn't have it
+        bool HasAttribute(std::string_view attributeName) const;
+    };
+
+    class HtmlTokenizer
+    {
+    public:
+        HtmlTokenizer(std::string_view data, std::string_view ns) : _data(data), _ns(ns) {} // ns: e.g. "GridIron"
+
+        bool Next(HtmlToken &token); // the next token, false at the end of the buffer
+        inline size_t Position() const { return _pos; }; // where the next token starts
+
+        // parse the attributes of an opening tag (e.g. "<a href=x>") into attributes, replacing what was there.
+        // returns false if the tag isn't terminated
+        static bool ParseAttributes(std::string_view tag, std::vector<tag_attribute> &attributes);
+
+    private:
+        size_t findTag(size_t from) const;               // offset of the next of our tags at or after from, npos if none
+        size_t nameEnd(size_t from) const;               // end of the tag name starting at from
+        bool isOurs(std::string_view name) const;        // Namespace::Type in our namespace
+        static size_t tagEnd(std::string_view data, size_t from); // just past the '>' closing the tag at from, npos if unterminated
+
+        std::string_view _data;
+        std::string_view _ns;
+        size_t _pos = 0;
+    };
+}
+
+#endif
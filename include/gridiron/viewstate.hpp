@@ -0,0 +1,118 @@
+/****************************************************************************************
+ * (C) Copyright 2009-2024
+ *    Jessica Mulein <jessica@digitaldefiance.org>
+ *    Digital Defiance and Contributors <https://digitaldefiance.org>
+ *
+ * Others will be credited if more developers join.
+ *
+ * License
+ *
+ * This code is licensed under the Apache license.
+ * Please see COPYING in the root of this package for details.
+ *
+ * The following libraries are only linked in, and no code is based directly from them:
+ * htmlcxx is under the Apache 2.0 License
+ ***************************************************************************************
+ * ViewState Classes
+ * -----------------
+ *
+ * State of a page's controls that round-trips through the client, in the __VIEWSTATE
+ * hidden field. Binary, then base64url so it can sit in an attribute:
+ *
+ *   version      1 byte
+ *   flags        1 byte, bit 0: body is deflated
+ *   raw length   varint, only if deflated
+ *   body         varint count of property names, then each name (length prefixed)
+ *                varint count of controls, then for each: id, varint count of
+ *                properties, then for each: name index, value (length prefixed)
+ *   mac          HMAC-SHA256 of the scope (length prefixed), then everything before it
+ *
+ * The scope names what the token belongs to, for a page its front page. It isn't in the
+ * token, so a token only authenticates against the page that issued it: replaying it on
+ * another page with the same control ids fails.
+ *
+ * Lengths and counts are LEB128 varints; property names are interned, so "Text" costs
+ * one byte per control. A token that doesn't authenticate, or is from another version,
+ * is rejected as a whole. Parsing doesn't copy: names, ids and values are views into
+ * the decoded buffer held by the ViewState.
+ ***************************************************************************************/
+
+#ifndef _VIEWSTATE_HPP_
+#define _VIEWSTATE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace GridIron
+{
+    // the state of one control as read back from a token
+    struct ViewStateControl
+    {
+        std::string_view id;
+        std::vector<std::pair<std::string_view, std::string_view>> properties; // name, value
+
+        std::string_view Get(std::string_view name, std::string_view defaultValue = std::string_view()) const;
+        bool GetInt(std::string_view name, int64_t &value) const; // false if missing or not an integer
+        bool Has(std::string_view name) const;
+    };
+
+    class ViewStateWriter
+    {
+    public:
+        void BeginControl(std::string_view id); // the properties written next belong to this control
+        void Write(std::string_view name, std::string_view value);
+        void Write(std::string_view name, int64_t value); // zigzag varint
+
+        inline bool Empty() const { return _controls == 0 && _propertyCount == 0; }; // nothing written yet
+
+        // the token: authenticated with key and scope, deflated if that makes it smaller (and zlib is built in)
+        std::string Finish(std::string_view key, std::string_view scope = std::string_view(), bool compress = true);
+
+    private:
+        void endControl();
+
+        std::vector<std::string> _names;                    // interned property names, by index
+        std::unordered_map<std::string, size_t> _nameIndex; // name -> index
+        std::string _body;                                  // finished controls
+        std::string _id;                                    // control being written
+        std::string _properties;                            // its properties so far
+        size_t _propertyCount = 0;
+        size_t _controls = 0;
+        bool _open = false;
+    };
+
+    class ViewState
+    {
+    public:
+        static constexpr uint8_t Version = 1;
+        static constexpr uint8_t FlagDeflated = 0x01;
+        static constexpr size_t MaxBody = 1 << 20; // refuse to inflate anything bigger
+
+        // the process-wide signing key. Random per process unless set at startup (before serving), so set it
+        // if postbacks can land on another process or survive a restart.
+        static const std::string &Key();
+        static void SetKey(std::string key);
+
+        // decode and authenticate a token, replacing whatever was parsed before. false if it isn't valid,
+        // or was made for another scope.
+        bool Parse(std::string_view token, std::string_view key = Key(), std::string_view scope = std::string_view());
+
+        const ViewStateControl *Find(std::string_view id) const; // nullptr if the token has nothing for it
+        inline const std::vector<ViewStateControl> &Controls() const { return _controls; };
+
+    private:
+        bool parseBody(std::string_view body);
+
+        std::string _decoded;  // the token after base64
+        std::string _inflated; // the body, if it was deflated
+        std::vector<std::string_view> _names;
+        std::vector<ViewStateControl> _controls;
+    };
+}
+
+#endif
@@ -4,6 +4,9 @@
 
 #include "oatpp/network/Server.hpp"
 
+#include <gridiron/template.hpp>
+#include "testapp.hpp" // generated by gridiron-templatec
+
 #include <iostream>
 
 /**
@@ -21,6 +24,12 @@ void run() {
 
   router->addController(RootController::createShared());
 
+  /* serve the front page compiled into the binary */
+  GridIron::compiled::testapp::Preload();
+
+  /* pick up edits to the front pages without restarting */
+  GridIron::TemplateCache::Instance().Watch();
+
   /* create server */
   oatpp::network::Server server(components.serverConnectionProvider.getObject(),
                                 components.serverConnectionHandler.getObject());
@@ -28,6 +37,8 @@ void run() {
   OATPP_LOGD("Server", "Running on port %s...", components.serverConnectionProvider.getObject()->getProperty("port").toString()->c_str());
   
   server.run();
+
+  GridIron::TemplateCache::Instance().Unwatch();
   
 }
 
@@ -2,13 +2,18 @@
 #ifndef RootController_hpp
 #define RootController_hpp
 
-#include <sstream>
 #include "oatpp/web/server/api/ApiController.hpp"
 #include "oatpp/core/macro/codegen.hpp"
 #include "oatpp/core/macro/component.hpp"
 #include <gridiron/gridiron.hpp>
+#include <gridiron/controls/ui/button.hpp>
 #include <gridiron/controls/ui/label.hpp>
+#include <gridiron/controls/ui/textbox.hpp>
 #include <gridiron/controls/page.hpp>
+#include <gridiron/formbody.hpp>
+#include <gridiron/pagebody.hpp>
+#include "testapp.hpp" // generated by gridiron-templatec
+#include "oatpp/web/protocol/http/outgoing/StreamingBody.hpp"
 
 #include OATPP_CODEGEN_BEGIN(ApiController) //<-- Begin codegen
 
@@ -36,6 +41,39 @@ public:
         return std::shared_ptr<RootController>(new RootController(objectMapper));
     }
 
+    /**
+     *  The demo page with its code-beside controls, shared by GET and POST
+     */
+    static std::shared_ptr<GridIron::Page> createPage()
+    {
+        namespace testapp = GridIron::compiled::testapp;
+
+        // compiled in at build time, the cache already has it
+        auto page = std::make_shared<GridIron::Page>(std::string(testapp::FrontPage));
+        // allocated in the page's arena, so they live exactly as long as the page (and the streaming body)
+        auto lblTest = page->Create<GridIron::controls::Label>(std::string(testapp::ids::lblTest));
+
+        page->RegisterVariable(std::string(testapp::values::lblTest_Text), lblTest->GetTextPtr());
+        lblTest->SetText("these contents were replaced");
+
+        auto txtEcho = page->Create<GridIron::controls::TextBox>(std::string(testapp::ids::txtEcho));
+        auto lblEcho = page->Create<GridIron::controls::Label>(std::string(testapp::ids::lblEcho));
+        page->Create<GridIron::controls::Button>(std::string(testapp::ids::btnSend))
+            ->OnClick([txtEcho, lblEcho](GridIron::controls::Button &, std::string_view)
+                      { lblEcho->SetText(txtEcho->GetText()); });
+        return page;
+    }
+
+    // the page renders as the response is written out, no intermediate string
+    static std::shared_ptr<OutgoingResponse> pageResponse(std::shared_ptr<GridIron::Page> page)
+    {
+        auto body = std::make_shared<oatpp::web::protocol::http::outgoing::StreamingBody>(
+            std::make_shared<GridIron::PageBody>(std::move(page)));
+        auto response = OutgoingResponse::createShared(Status::CODE_200, body);
+        response->putHeader("Content-Type", "text/html");
+        return response;
+    }
+
     /**
      *  Hello World endpoint Coroutine mapped to the "/" (root)
      */
@@ -43,18 +81,32 @@ public:
         ENDPOINT_ASYNC_INIT(Root)
 
             Action act() override{
+            return _return(pageResponse(createPage()));
+        }
+    }
+;
+
+    /**
+     *  The demo page's form posting back to itself
+     */
+    ENDPOINT_ASYNC("POST", "/", RootPostBack){
+        ENDPOINT_ASYNC_INIT(RootPostBack)
+
+            // parsed as it comes off the connection
+            std::shared_ptr<GridIron::FormBody> form = std::make_shared<GridIron::FormBody>();
 
-            auto page = std::make_shared<GridIron::Page>("gridiron-demo/testapp.html");
-            GridIron::controls::Label lblTest("lblTest", page);
+            Action act() override{
+            return request->transferBodyAsync(form).next(yieldTo(&RootPostBack::onForm));
+        }
 
-            page->RegisterVariable("lblTest_Text", lblTest.GetTextPtr());
-            lblTest.SetText("these contents were replaced");
+        Action onForm()
+        {
+            if (!form->Finish())
+                return _return(controller->createResponse(Status::CODE_413, "form too large"));
 
-            std::ostringstream pageContent;
-            pageContent << page;
-            auto response = controller->createResponse(Status::CODE_200, pageContent.str().c_str());
-            response->putHeader("Content-Type", "text/html");
-            return _return(response);
+            auto page = createPage();
+            page->ProcessPostBack(form->Form()); // events run here, before the page renders
+            return _return(pageResponse(page));
         }
     }
 ;
@@ -0,0 +1,47 @@
+/****************************************************************************************
+ * (C) Copyright 2009-2024
+ *    Jessica Mulein <jessica@digitaldefiance.org>
+ *    Digital Defiance and Contributors <https://digitaldefiance.org>
+ *
+ * Others will be credited if more developers join.
+ *
+ * License
+ *
+ * This code is licensed under the Apache license.
+ * Please see COPYING in the root of this package for details.
+ *
+ * The following libraries are only linked in, and no code is based directly from them:
+ * htmlcxx is under the Apache 2.0 License
+ ***************************************************************************************
+ * Arena Class
+ * -----------
+ *
+ * Per-page monotonic allocator. See arena.hpp.
+ ***************************************************************************************/
+
+#include <gridiron/arena.hpp>
+
+namespace GridIron
+{
+    Arena::Arena() : _resource(_inline, sizeof(_inline))
+    {
+    }
+
+    Arena::~Arena()
+    {
+        Clear();
+    }
+
+    void Arena::Clear()
+    {
+        // destructors may still look at other arena objects (a control unregistering from its parent),
+        // so run them all before any memory goes back
+        while (_finalizers != nullptr)
+        {
+            Finalizer *finalizer = _finalizers;
+            _finalizers = finalizer->next;
+            finalizer->destroy(finalizer->object);
+        }
+        _resource.release();
+    }
+}
@@ -0,0 +1,372 @@
+/****************************************************************************************
+ * (C) Copyright 2009-2024
+ *    Jessica Mulein <jessica@digitaldefiance.org>
+ *    Digital Defiance and Contributors <https://digitaldefiance.org>
+ *
+ * Others will be credited if more developers join.
+ *
+ * License
+ *
+ * This code is licensed under the Apache license.
+ * Please see COPYING in the root of this package for details.
+ *
+ * The following libraries are only linked in, and no code is based directly from them:
+ * htmlcxx is under the Apache 2.0 License
+ ***************************************************************************************
+ * Render benchmarks
+ * -----------------
+ *
+ * Times every stage of getting a page out the door, over synthetic front pages of
+ * 1 KB to 10 MB holding 0 to 10,000 controls. Besides time, each benchmark reports
+ * bytes/op (output or input size) and allocs/op (calls to operator new, counted by
+ * the replacement below).
+ *
+ *   gridiron-bench --benchmark_filter=Render
+ ***************************************************************************************/
+
+#include <benchmark/benchmark.h>
+
+#include <gridiron/gridiron.hpp>
+#include <gridiron/renderbuffer.hpp>
+#include <gridiron/tag.hpp>
+#include <gridiron/template.hpp>
+#include <gridiron/controls/page.hpp>
+#include <gridiron/controls/ui/label.hpp>
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <string>
+
+// every allocation in the process goes through here so benchmarks can report allocs/op
+static std::atomic<size_t> allocationCount{0};
+
+// out of line, so GCC can't see a new paired with free (-Wmismatched-new-delete) once it inlines a delete
+[[gnu::noinline]] static void release(void *p) noexcept
+{
+    std::free(p);
+}
+
+void *operator new(size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size != 0 ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void *operator new(size_t size, std::align_val_t alignment)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    const size_t align = static_cast<size_t>(alignment);
+    const size_t rounded = (size + align - 1) / align * align; // aligned_alloc wants a multiple of the alignment
+    if (void *p = std::aligned_alloc(align, rounded != 0 ? rounded : align))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { release(p); }
+void operator delete(void *p, size_t) noexcept { release(p); }
+void operator delete(void *p, std::align_val_t) noexcept { release(p); }
+void operator delete(void *p, size_t, std::align_val_t) noexcept { release(p); }
+
+namespace
+{
+    using GridIron::Page;
+    using GridIron::Template;
+
+    // reports allocs/op and bytes/op for the loop it was created before
+    class OpCounters
+    {
+    public:
+        OpCounters() : _start(allocationCount.load(std::memory_order_relaxed)) {}
+
+        void Report(benchmark::State &state, size_t bytesPerOp)
+        {
+            const double allocations = static_cast<double>(allocationCount.load(std::memory_order_relaxed) - _start);
+            state.counters["allocs/op"] = benchmark::Counter(allocations, benchmark::Counter::kAvgIterations);
+            state.counters["bytes/op"] = static_cast<double>(bytesPerOp);
+            state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytesPerOp));
+        }
+
+    private:
+        size_t _start;
+    };
+
+    // exposes binding, which is normally only run by render
+    class BenchPage : public Page
+    {
+    public:
+        using Page::Page;
+        using Page::bind;
+    };
+
+    // front page of roughly the given size with the given number of auto labels, each one followed by a
+    // Value tag reading its text back. Padded out with plain markup.
+    std::string makePage(size_t bytes, size_t controls)
+    {
+        std::string html = "<!DOCTYPE html>\n<GridIron::Page lang=\"en\">\n<head><title>bench</title></head>\n<body>\n";
+        for (size_t i = 0; i < controls; ++i)
+        {
+            const std::string id = "lbl" + std::to_string(i);
+            html += "<div><GridIron::Label auto=\"true\" id=\"" + id + "\">text of " + id +
+                    " &amp; co</GridIron::Label> <GridIron::Value key=\"" + id + ".Text\" /></div>\n";
+        }
+        static const std::string filler =
+            "<p class=\"filler\">Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod.</p>\n";
+        while (html.size() + filler.size() < bytes)
+            html += filler;
+        html += "</body>\n</GridIron::Page>\n";
+        return html;
+    }
+
+    // pages are generated once per (size, controls) and shared by all benchmarks
+    const std::string &syntheticPage(size_t bytes, size_t controls)
+    {
+        static std::map<std::pair<size_t, size_t>, std::string> pages;
+        auto it = pages.find({bytes, controls});
+        if (it == pages.end())
+            it = pages.emplace(std::make_pair(bytes, controls), makePage(bytes, controls)).first;
+        return it->second;
+    }
+
+    std::shared_ptr<const Template> syntheticTemplate(size_t bytes, size_t controls)
+    {
+        static std::map<std::pair<size_t, size_t>, std::shared_ptr<const Template>> templates;
+        auto it = templates.find({bytes, controls});
+        if (it == templates.end())
+            it = templates.emplace(std::make_pair(bytes, controls),
+                                   std::make_shared<const Template>("::bench::", syntheticPage(bytes, controls)))
+                     .first;
+        return it->second;
+    }
+
+    // 1 KB .. 10 MB x 0 .. 10,000 controls, skipping pages too small to hold that many
+    void pageSizes(benchmark::internal::Benchmark *b)
+    {
+        for (int64_t bytes : {1 << 10, 64 << 10, 1 << 20, 10 << 20})
+            for (int64_t controls : {0, 10, 1000, 10000})
+                if (controls * 120 < bytes)
+                    b->Args({bytes, controls});
+        b->ArgNames({"bytes", "controls"});
+    }
+
+    void BM_TemplateLoad(benchmark::State &state)
+    {
+        const std::string &html = syntheticPage(state.range(0), state.range(1));
+        const std::filesystem::path path = std::filesystem::temp_directory_path() / "gridiron-bench.html";
+        std::ofstream(path, std::ios::binary) << html;
+
+        OpCounters counters;
+        for (auto _ : state)
+            benchmark::DoNotOptimize(Template::FromFile(path.string()));
+        counters.Report(state, html.size());
+        std::filesystem::remove(path);
+    }
+    BENCHMARK(BM_TemplateLoad)->Apply(pageSizes)->Unit(benchmark::kMicrosecond);
+
+    // tokenize plus plan compile, without the file read
+    void BM_TemplateParse(benchmark::State &state)
+    {
+        const std::string &html = syntheticPage(state.range(0), state.range(1));
+
+        OpCounters counters;
+        for (auto _ : state)
+            benchmark::DoNotOptimize(std::make_shared<const Template>("::bench::", html));
+        counters.Report(state, html.size());
+    }
+    BENCHMARK(BM_TemplateParse)->Apply(pageSizes)->Unit(benchmark::kMicrosecond);
+
+    // page construction: slot setup and creating the autos
+    void BM_CreateAutos(benchmark::State &state)
+    {
+        auto compiled = syntheticTemplate(state.range(0), state.range(1));
+
+        OpCounters counters;
+        for (auto _ : state)
+        {
+            BenchPage page("bench", compiled);
+            benchmark::DoNotOptimize(&page);
+        }
+        counters.Report(state, compiled->Data().size());
+    }
+    BENCHMARK(BM_CreateAutos)->Apply(pageSizes)->Unit(benchmark::kMicrosecond);
+
+    // the check render makes before every page, once everything is bound
+    void BM_Bind(benchmark::State &state)
+    {
+        auto compiled = syntheticTemplate(state.range(0), state.range(1));
+        BenchPage page("bench", compiled);
+
+        OpCounters counters;
+        for (auto _ : state)
+            page.bind();
+        counters.Report(state, compiled->Data().size());
+    }
+    BENCHMARK(BM_Bind)->Apply(pageSizes)->Unit(benchmark::kMicrosecond);
+
+    // a single control slot (the page-level replacement for the old renderNode)
+    void BM_RenderControl(benchmark::State &state)
+    {
+        Page page("");
+        auto label = page.Create<GridIron::controls::Label>("lblBench", std::string(state.range(0), 'x') + " & <y>");
+        std::string data;
+
+        OpCounters counters;
+        for (auto _ : state)
+        {
+            data.clear();
+            label->render(data);
+            benchmark::DoNotOptimize(data.data());
+        }
+        counters.Report(state, data.size());
+    }
+    BENCHMARK(BM_RenderControl)->Arg(16)->Arg(1024)->Arg(64 << 10);
+
+    // input of the given size, with an escape every state.range(1) bytes (0 = none)
+    void BM_XmlEncode(benchmark::State &state)
+    {
+        std::string input(state.range(0), 'a');
+        if (state.range(1) > 0)
+            for (size_t i = 0; i < input.size(); i += state.range(1))
+                input[i] = "<>&\"'"[i % 5];
+        std::string out;
+
+        OpCounters counters;
+        for (auto _ : state)
+        {
+            out.clear();
+            GridIron::xmlEncode(input, out);
+            benchmark::DoNotOptimize(out.data());
+        }
+        counters.Report(state, input.size());
+    }
+    BENCHMARK(BM_XmlEncode)->ArgsProduct({{16, 1 << 10, 1 << 20}, {0, 64, 4}})->ArgNames({"bytes", "every"});
+
+    void BM_TagSerialize(benchmark::State &state)
+    {
+        GridIron::Tag tag("div", "contents",
+                          {{"id", "lblBench"},
+                           {"class", "label & \"quoted\""},
+                           {"style", "align: left; height: 10px; width: 100px;"}});
+        std::string data;
+
+        OpCounters counters;
+        for (auto _ : state)
+        {
+            data.clear();
+            tag.render(data);
+            benchmark::DoNotOptimize(data.data());
+        }
+        counters.Report(state, data.size());
+    }
+    BENCHMARK(BM_TagSerialize);
+
+    // bind and render the whole page into a string
+    void BM_Render(benchmark::State &state)
+    {
+        auto compiled = syntheticTemplate(state.range(0), state.range(1));
+        Page page("bench", compiled);
+        std::string data;
+
+        OpCounters counters;
+        for (auto _ : state)
+        {
+            data.clear();
+            page.render(data);
+            benchmark::DoNotOptimize(data.data());
+        }
+        counters.Report(state, data.size());
+    }
+    BENCHMARK(BM_Render)->Apply(pageSizes)->Unit(benchmark::kMicrosecond);
+
+    // a new output buffer for every render, as requests get: a fresh string, or this thread's reused RenderBuffer
+    void BM_RenderRequest(benchmark::State &state)
+    {
+        auto compiled = syntheticTemplate(state.range(0), state.range(1));
+        Page page("bench", compiled);
+        const bool reuse = state.range(2) != 0;
+        size_t size = 0;
+
+        OpCounters counters;
+        for (auto _ : state)
+        {
+            if (reuse)
+            {
+                GridIron::RenderBuffer data;
+                page.render(data.String());
+                size = data.Size();
+                benchmark::DoNotOptimize(data.String().data());
+            }
+            else
+            {
+                std::string data;
+                page.render(data);
+                size = data.size();
+                benchmark::DoNotOptimize(data.data());
+            }
+        }
+        counters.Report(state, size);
+    }
+    BENCHMARK(BM_RenderRequest)
+        ->ArgsProduct({{64 << 10, 1 << 20}, {10, 1000}, {0, 1}})
+        ->ArgNames({"bytes", "controls", "reuse"})
+        ->Unit(benchmark::kMicrosecond);
+
+    // one label changes between renders of a page that is kept around
+    void BM_Refresh(benchmark::State &state)
+    {
+        auto compiled = syntheticTemplate(state.range(0), state.range(1));
+        Page page("bench", compiled);
+        auto label = dynamic_cast<GridIron::controls::Label *>(page.FindByID("lbl0"));
+        page.Refresh();
+
+        OpCounters counters;
+        size_t n = 0;
+        for (auto _ : state)
+        {
+            if (label != nullptr)
+                label->SetText((++n & 1) ? "odd" : "even");
+            benchmark::DoNotOptimize(page.Refresh().data());
+        }
+        counters.Report(state, page.Refresh().size());
+    }
+    BENCHMARK(BM_Refresh)->Apply(pageSizes)->Unit(benchmark::kMicrosecond);
+
+    // bind and stream the whole page through a PageReader in 64 KB pieces, as the response body does
+    void BM_RenderStreamed(benchmark::State &state)
+    {
+        auto page = std::make_shared<Page>("bench", syntheticTemplate(state.range(0), state.range(1)));
+        static char buffer[64 << 10];
+        size_t total = 0;
+
+        OpCounters counters;
+        for (auto _ : state)
+        {
+            GridIron::PageReader reader(page);
+            total = 0;
+            while (size_t n = reader.Read(buffer, sizeof(buffer)))
+                total += n;
+            benchmark::DoNotOptimize(buffer);
+        }
+        counters.Report(state, total);
+    }
+    BENCHMARK(BM_RenderStreamed)->Apply(pageSizes)->Unit(benchmark::kMicrosecond);
+}
+
+int main(int argc, char **argv)
+{
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv))
+        return 1;
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
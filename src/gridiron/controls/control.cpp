@@ -25,21 +25,29 @@
 #include <algorithm>
 #include <gridiron/controls/page.hpp>
 #include <gridiron/controls/control.hpp>
+#include <gridiron/controls/ui/button.hpp>
+#include <gridiron/controls/ui/label.hpp>
+#include <gridiron/controls/ui/textbox.hpp>
+#include <gridiron/controls/ui/viewstatefield.hpp>
 
 namespace GridIron
 {
     const std::string Control::HtmlNamespace = GRIDIRON_XHTML_NS;
 
-    Control::Control(std::string id, std::shared_ptr<Control> parent)
+    // children of controls under a page come out of the page's arena. A page's own list
+    // can't: the page (and its arena) isn't constructed yet when this runs.
+    static std::pmr::memory_resource *childResource(Control *parent)
     {
-        std::shared_ptr<Control> result = nullptr;
-        std::shared_ptr<Control> _Page;
+        Page *page = (parent != nullptr) ? parent->GetPage() : nullptr;
+        return (page != nullptr) ? page->GetArena().Resource() : std::pmr::get_default_resource();
+    }
+
+    Control::Control(std::string id, Control *parent)
+        : _id(std::move(id)), _parent(parent), _children(childResource(parent))
+    {
+        Page *_Page;
 
         // INITIALIZE VARIABLES
-        // our id
-        _id = id;
-        // our parent, as given
-        _parent.swap(parent);
         // whether this page should be serialized into the viewstate
         _viewStateEnabled = false;
         // whether this is an autonomous control - affects behavior in derived classes
@@ -52,13 +60,13 @@ namespace GridIron
         if (_id.length() == 0)
             throw GridException(200, "no id specified");
 
-        // find the page control if we have one, then look to see if the id is already registered
+        // find the page control if we have one, then claim the id in its registry
+        // (a page under construction is not a Page yet as far as GetPage is concerned, so pages don't register themselves)
         _Page = GetPage();
         if (_Page != nullptr)
         {
             // check page for existing controls with that id
-            result = _Page->FindByID(_id, true);
-            if (result != nullptr)
+            if (!_Page->Registry().Register(this))
                 throw GridException(201, "id already in use");
 
             // register ourselves with the parent if we have one (pages dont)
@@ -74,51 +82,39 @@ namespace GridIron
         return os;
     }
 
-    std::shared_ptr<Control> Control::This()
-    {
-        return shared_from_this();
-    }
-
     // find the bottom-most control, regardless of type
     // returns: pointer - may be self
-    std::shared_ptr<Control>
+    Control *
     Control::GetRoot(void)
     {
-        std::shared_ptr<Control> ptr = This();
+        Control *ptr = this;
 
         while (ptr->_parent != nullptr)
-        {
-            return _parent->This();
-        }
+            ptr = ptr->_parent;
 
         return ptr;
     }
 
     // find the bottom-most control, only if a Page object
     // returns: pointer on success or nullptr, may be self
-    std::shared_ptr<Control>
+    Page *
     Control::GetPage(void)
     {
-        std::shared_ptr<Control> ptr = GetRoot();
-        Control *p = ptr.get();
-        if (!Page::instanceOf<Page>(p))
-            return nullptr;
-        else
-            return ((Page *)p)->This();
+        return dynamic_cast<Page *>(GetRoot());
     }
 
-    std::shared_ptr<Control> Control::Find(Control &control)
+    // returns the instance if it is the one registered on our page under its id
+    Control *Control::Find(Control &control)
     {
-        auto it = _controlsByControl.find(&control);
-        if (it != _controlsByControl.end())
-        {
-            return it->second;
-        }
-        return nullptr;
+        Page *page = GetPage();
+        if (page == nullptr)
+            return nullptr;
+        Control *found = page->Registry().Find(control.ID());
+        return (found == &control) ? found : nullptr;
     }
 
-    // recursive search through all controls under this object, return the one with specified id
-    std::shared_ptr<Control> Control::FindByID(const std::string &id, bool searchParentsIfNotChild = false)
+    // search through the controls under this object, return the one with specified id
+    Control *Control::FindByID(const std::string &id, bool searchParentsIfNotChild)
     {
         // Check immediate children first
         for (auto &child : _children)
@@ -129,20 +125,18 @@ namespace GridIron
             }
         }
 
-        // Optionally search in the global map
+        // Optionally search the whole page
         if (searchParentsIfNotChild)
         {
-            auto it = _controlsByID.find(id);
-            if (it != _controlsByID.end())
-            {
-                return it->second;
-            }
+            Page *page = GetPage();
+            if (page != nullptr)
+                return page->Registry().Find(id);
         }
 
         return nullptr;
     }
 
-    static std::string GetFullName(std::string tag)
+    std::string Control::GetFullName(std::string tag)
     {
         return (HtmlNamespace + "::" + tag);
     }
@@ -168,7 +162,7 @@ namespace GridIron
         return "div";
     }
 
-    // register this control with the parent
+    // register this control with the parent. We only keep a pointer, the child is owned elsewhere.
     bool Control::registerChild(std::string id, Control *control)
     {
         if (id.empty() || control == nullptr)
@@ -176,10 +170,7 @@ namespace GridIron
             return false;
         }
 
-        auto sharedControl = std::shared_ptr<Control>(control);
-        _children.push_back(sharedControl);
-        _controlsByID[id] = sharedControl;
-        _controlsByControl[control] = sharedControl;
+        _children.push_back(control);
 
         return true;
     }
@@ -188,15 +179,10 @@ namespace GridIron
     bool Control::unregister_child(std::string &id)
     {
         auto it = std::find_if(_children.begin(), _children.end(),
-                               [&id](const std::shared_ptr<Control> &control)
+                               [&id](const Control *control)
                                { return control->ID() == id; });
         if (it != _children.end())
         {
-            _controlsByID.erase(id);
-            _controlsByControl.erase(it->get());
-            // Remove from other maps if necessary
-            // ...
-
             _children.erase(it);
             return true;
         }
@@ -206,6 +192,11 @@ namespace GridIron
     // destructor
     Control::~Control()
     {
+        // give our id back to the page
+        Page *page = GetPage();
+        if (page != nullptr && page != this)
+            page->Registry().Unregister(this);
+
         // unregister ourselves from the parent if we have one (pages dont)
         if (_parent != nullptr)
             _parent->unregister_child(_id);
@@ -213,7 +204,7 @@ namespace GridIron
 
     // allow page class to tell us where our data is
     void
-    Control::SetHTMLNode(htmlnode *node)
+    Control::SetHTMLNode(const htmlnode *node)
     {
         if ((_htmlNode != nullptr) && (node != nullptr))
         {
@@ -229,110 +220,147 @@ namespace GridIron
         _autonomous = isauto;
     }
 
-    std::shared_ptr<Control> Control::fromHtmlNode(htmlnode &node)
+    void
+    Control::MarkDirty()
     {
-        // Ensure the node is valid
-        if (node == nullptr)
+        for (Control *control = this; control != nullptr; control = control->_parent)
         {
-            throw GridException(301, "HTML Tag not found for this instance");
+            if (control->_renderSlot != NoSlot)
+            {
+                if (Page *page = GetPage())
+                    page->controlChanged(control->_renderSlot);
+                return;
+            }
         }
+    }
 
-        // Create a new Control instance
-        std::shared_ptr<Control> control = std::make_shared<Control>();
-
-        // Set the HTML node for the control
-        control->SetHTMLNode(&node);
-
-        // Extract the ID from the node, if available
-        std::string id = ""; // Replace with actual method to extract ID from node
-        control->_id = id;
-
-        // Check if the control is part of a page
-        std::shared_ptr<Page> _Page = control->GetPage();
-        if (_Page == nullptr)
-        {
-            throw GridException(300, "Control must be attached to a page");
-        }
+    // nothing to keep by default
+    void
+    Control::SaveViewState(ViewStateWriter &writer)
+    {
+    }
 
-        // Process the text content of the node
-        // This is a placeholder for actual logic to process the node's content
-        std::string textContent = ""; // Replace with actual method to extract text content
-        control->_text = textContent;
+    void
+    Control::LoadViewState(const ViewStateControl &state)
+    {
+    }
 
-        // Register the text string for access if the control is autonomous
-        if (control->_autonomous)
-        {
-            _Page->RegisterVariable(id + ".Text", &control->_text);
-        }
+    void
+    Control::NotifyReady()
+    {
+        if (Page *page = GetPage())
+            page->controlReady();
+    }
 
-        return control;
+    // controls that don't take input ignore what's posted under their id
+    bool
+    Control::LoadPostData(std::string_view value)
+    {
+        return false;
     }
 
-    // ------------------------------------------------
-    // The following are used to allow us to instantiate control classes by type name as autonomous controls
-    // Derived from Dr. Dobbs http://www.ddj.com/184410633
-    ControlFactory::ControlFactory()
+    void
+    Control::RaisePostDataChanged()
     {
-        // MUST be empty- see article
     }
 
-    ControlFactory::~ControlFactory()
+    void
+    Control::RaisePostBackEvent(std::string_view argument)
     {
-        // individual entries need not be deleted
-        delete _controlProxies;
     }
 
-    // if the list of proxies is empty, create it
+    // the page looks at this when it renders us
     void
-    ControlFactory::Init()
+    Control::SetOutputCache(const OutputCachePolicy &policy)
     {
-        if (!_controlProxies)
-            _controlProxies = new factory_vector;
+        if (policy.duration.count() <= 0)
+            _outputCache.reset();
+        else
+            _outputCache = std::make_unique<OutputCachePolicy>(policy);
     }
 
-    // the derived control classes' .cpp files instantiate
-    // a proxy class, which calls this, effectively adding themselves
+    // allow the page class to hand us our tag. Derived classes pick their defaults out of it.
     void
+    Control::fromHtmlNode(const htmlnode &node, std::string_view source)
+    {
+        SetHTMLNode(&node);
+    }
+
+    // ------------------------------------------------
+    // The following are used to allow us to instantiate control classes by type name as autonomous controls
+    // Derived from Dr. Dobbs http://www.ddj.com/184410633
+    //
+    // The article relied on the factory being a global constructed before any proxy registered with it.
+    // A function local static gets constructed on first use instead, whatever the static init order.
+    //
+    // The built-in controls are registered right here rather than by statics in their own .cpp files: those
+    // files are in a static library, and a file nothing else refers to gets left out of the link.
+    ControlFactory &
+    ControlFactory::Instance()
+    {
+        static ControlFactory factory = []
+        {
+            ControlFactory builtin;
+            builtin.Register(&ControlFactoryProxy<controls::Button>::Instance());
+            builtin.Register(&ControlFactoryProxy<controls::Label>::Instance());
+            builtin.Register(&ControlFactoryProxy<controls::TextBox>::Instance());
+            builtin.Register(&ControlFactoryProxy<controls::ViewStateField>::Instance());
+            return builtin;
+        }();
+        return factory;
+    }
+
+    // other control classes' .cpp files instantiate a ControlTypeList, which calls this for each
+    // type, effectively adding themselves. Kept sorted by type name so lookups can binary search.
+    bool
     ControlFactory::Register(const ControlFactoryProxyBase *proxy)
     {
         if (proxy == nullptr)
-            return;
-        Init();
-        _controlProxies->push_back(proxy);
+            return false;
+
+        const std::string_view type = proxy->GetType();
+        auto it = std::lower_bound(_controlProxies.begin(), _controlProxies.end(), type,
+                                   [](const factory_vector::value_type &entry, std::string_view key)
+                                   { return entry.first < key; });
+        if (it != _controlProxies.end() && it->first == type)
+            return false;
+
+        _controlProxies.insert(it, std::make_pair(type, proxy));
+        return true;
+    }
+
+    const ControlFactoryProxyBase *
+    ControlFactory::Find(std::string_view type) const
+    {
+        auto it = std::lower_bound(_controlProxies.begin(), _controlProxies.end(), type,
+                                   [](const factory_vector::value_type &entry, std::string_view key)
+                                   { return entry.first < key; });
+        if (it == _controlProxies.end() || it->first != type)
+            return nullptr;
+        return it->second;
     }
 
     // how many class types are registered
     int
-    ControlFactory::GetCount()
+    ControlFactory::GetCount() const
     {
-        if (!_controlProxies)
-            return 0;
-        else
-            return _controlProxies->size();
+        return static_cast<int>(_controlProxies.size());
     }
 
     // wrapper to get access
     const ControlFactoryProxyBase *
-    ControlFactory::GetAt(int i)
+    ControlFactory::GetAt(int i) const
     {
-        return _controlProxies->at(i);
+        return _controlProxies.at(i).second;
     }
 
-    // iterates through the control types that have registered, tells the proxy to create us one if its type matches
+    // finds the proxy for the type and tells it to create us one
     Control *
-    ControlFactory::CreateByType(const char *type, const char *id, Control *parent)
+    ControlFactory::CreateByType(std::string_view type, const std::string &id, Control *parent, Arena &arena)
     {
-        std::cerr << "Requesting creation of type " << type << std::endl;
-        for (int i = 0; i < _controlProxies->size(); ++i)
-        {
-            if (strcmp(_controlProxies->at(i)->GetType(), type) == 0)
-            {
-                return _controlProxies->at(i)->CreateObject(id, parent, type);
-            }
-        }
-        return nullptr;
+        const ControlFactoryProxyBase *proxy = Find(type);
+        if (proxy == nullptr)
+            return nullptr;
+        return proxy->CreateObject(id, parent, arena);
     }
-
-    // global factory instance
-    ControlFactory globalControlFactory;
 }
@@ -24,88 +24,55 @@
  * supplied by a Page class's parsing operation.
  ***************************************************************************************/
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
-#include <fstream>
+#include <filesystem>
 #include <memory>
 #include <typeinfo>
 #include <gridiron/controls/page.hpp>
 #include <gridiron/gridiron.hpp>
 #include <gridiron/exceptions.hpp>
+#include <gridiron/log.hpp>
+#include <gridiron/renderbuffer.hpp>
+#include <gridiron/renderpool.hpp>
 
 using namespace GridIron;
 
-Page::Page(std::string frontPageFile) : Control(frontPageFile, nullptr)
+Page::Page(std::string frontPageFile)
+    : Page(frontPageFile.empty() ? std::string("::memory:") : frontPageFile,
+           frontPageFile.empty() ? nullptr : TemplateCache::Instance().Get(frontPageFile))
 {
-    int filesize = 0;
-    int bytesread = 0;
-    int i = 0;
+}
 
+Page::Page(std::string id, std::shared_ptr<const Template> frontPage) : Control(id, nullptr), _template(std::move(frontPage))
+{
     // save name for access
-    if (!frontPageFile.empty())
-        _htmlFile = frontPageFile;
-    else
-        _htmlFile = std::string("::memory:" + addressof(this));
+    _htmlFile = id;
 
     // make up an id until we parse and match up with one
     _id = std::string(HtmlNamespace + "::Page" + _htmlFile); // default id = "_Page_" or "_Page_foobar.html"
     _viewStateEnabled = false;                               // whether to output the viewstate
     _autonomous = Page::AllowAutonomous();                   // not applicable, page classes cannot be autonomous
 
-    if (frontPageFile.empty())
+    if (_template == nullptr)
     {
         // if no front-page is given, the caller will have to render everything themselves
         // this is fine, but we're done here.
         return;
     }
 
-    // open the front-page
-    const std::string fullPagePath = GridIron::PathToPage(frontPage);
-    std::ifstream file(fullPagePath, std::ios_base::in);
-    if (!file.is_open())
-        throw GridException(101, std::string("unable to open front-end page: ").append(fullPagePath).c_str());
-    _htmlFilepath = fullPagePath;
-
-    // base (control) class does not attempt to parse at all
-
-    // get length
-    file.seekg(0, std::ios_base::end);
-    filesize = file.tellg();
-    file.seekg(0, std::ios_base::beg);
-
-    if (filesize == 0)
-    {
-        file.close();
-        throw GridException(103, "front-end file is empty");
-    }
-
-    // allocate mem
-    std::string buffer;
-    buffer.reserve(filesize);
-    while (bytesread < filesize)
-    {
-        char buf[filesize - bytesread];
-        file.read(buf, filesize - bytesread);
-        const size_t gcount = file.gcount();
-        if (gcount == 0)
-            break;
-        bytesread += gcount;
-        buffer.append(buf, gcount);
-    }
-
-    // close the file
-    file.close();
-
-    // copy buffer to our store
-    _data.swap(buffer);
-
-    if (bytesread < filesize)
-    {
-        throw GridException(104, "unable to read front-end page");
-    }
+    // the template was read and parsed once by the cache, we only keep a reference to it
+    _htmlFilepath = _template->Path();
+    _controls.assign(_template->ControlCount(), nullptr);
+    _unbound = _template->ControlCount();
+    _values.assign(_template->ValueCount(), nullptr);
+    _dirtyControls = std::vector<std::atomic<bool>>(_template->ControlCount());
+    _dirtyValues = std::vector<std::atomic<bool>>(_template->ValueCount());
 
     // add default registered variables
-    _regvars[GRIDIRON_XHTML_NS + ".frontPage"] = &_htmlFilepath;
-    _regvars[GRIDIRON_XHTML_NS + ".frontPageFile"] = &_htmlFile;
+    RegisterVariable(HtmlNamespace + ".frontPage", &_htmlFilepath);
+    RegisterVariable(HtmlNamespace + ".frontPageFile", &_htmlFile);
 
     // we sort of have a problem here. _namespace is constant. We don't want it to change
     // but we can't make the right hand side of the  map constant
@@ -114,15 +81,15 @@ Page::Page(std::string frontPageFile) : Control(frontPageFile, nullptr)
     // types with some sort of wrapper class?
 
     //_regvars["__namespace"] = &_namespace;
-}
 
-std::shared_ptr<Page> Page::This()
-{
-    return shared_from_this();
+    // create the autos (in our arena) so code-beside can find them before render
+    bind();
 }
 
 Page::~Page()
 {
+    // controls in the arena unregister from us as they go, do that while the registry is still here
+    _arena.Clear();
 }
 
 const std::string Page::PathToPage(std::string frontPage)
@@ -131,213 +98,662 @@ const std::string Page::PathToPage(std::string frontPage)
     return basePath.append(GRIDIRON_HTML_DOCROOT).append(frontPage);
 }
 
-// TODO: all the std::cerr's are either debug printing or need to be converted to throws
+// Binds control instances to the control slots of the front page, in one pass over the template's control index.
+// The index (id, type, auto, attributes of each control tag) was built once per process by the TemplateCache, or at
+// build time by gridiron-templatec, and is shared read-only between all pages using the file. The html isn't looked at.
 //
-// This function uses htmlcxx to parse the html front page into a node tree
-//
-// Parsing happens in two passes- one automatically at instantiation of the page that searches for autos
-// and the second when render is called.
-// if the tree object has already been filled in, we know this is the second (or later) pass
-Page *
-Page::fromHtmlNode(htmlnode &node)
+// The page constructor calls this to create the autos, so code-beside can find them before render. The code-beside
+// controls don't exist yet at that point; render calls it again to bind them. Slots only get visited until they're
+// bound, once everything is bound this returns straight away.
+void Page::bind()
 {
-    int controlcount = 0;                 // how many custom controls we find
-    bool firstpass = (_tree.size() == 0); // have we already parsed this page?
+    if (_template == nullptr)
+        throw GridException(105, "bind called when front-end page not given or empty");
+    if (_autosCreated && _unbound == 0)
+        return;
+
+    const ConstArray<ControlTag> tags = _template->Controls();
+    for (size_t slot = 0; slot < tags.size(); ++slot)
+    {
+        if (_controls[slot] != nullptr)
+            continue;
+
+        const ControlTag &tag = tags[slot];
+        if (tag.id.empty())
+        {
+            // can never be bound, report it once and stop counting it
+            if (!_autosCreated)
+            {
+                GRIDIRON_LOG_WARN(_htmlFile, ": control tag is missing id: ", _template->ControlNode(slot).text());
+                --_unbound;
+            }
+            continue;
+        }
+
+        // look for any controls on the page with specified ID
+        Control *instance = _registry.Find(tag.id);
 
-    // _data contains the entire .html file, if given
-    if (_data.size() == 0)
-        throw GridException(105, "parse called when front-end page not given or empty");
+        if (tag.autonomous)
+        {
+            // autos are only created the first time through. If that didn't work it was reported then.
+            if (_autosCreated)
+                continue;
+            if (instance != nullptr)
+            {
+                GRIDIRON_LOG_WARN(_htmlFile, ": auto tag ", tag.type, " wants an id already in use by a ", instance->fullName());
+                --_unbound;
+                continue;
+            }
+
+            // the control class must be registered with the factory. Only classes that support autos should register.
+            instance = ControlFactory::Instance().CreateByType(tag.type, std::string(tag.id), this, _arena);
+            if (instance == nullptr)
+            {
+                GRIDIRON_LOG_WARN(_htmlFile, ": unable to create autonomous control of type ", tag.type);
+                --_unbound;
+                continue;
+            }
+            GRIDIRON_LOG_DEBUG("created auto ", tag.type, " id=", tag.id, " in slot ", slot);
+        }
+        else
+        {
+            // code-beside creates its controls after the page, so it may not be there yet
+            if (instance == nullptr)
+                continue;
+
+            // make sure the instance with that ID is the same type as the control tag
+            if (instance->controlTagName() != tag.type)
+            {
+                GRIDIRON_LOG_WARN(_htmlFile, ": instance with id ", tag.id, " is not a ", tag.type);
+                continue;
+            }
+
+            // already has an html node associated, we've already seen this id in the file- duplicate
+            if (instance->HTMLNodeRegistered())
+            {
+                GRIDIRON_LOG_TRACE("control ", tag.id, " already bound");
+                continue;
+            }
+            GRIDIRON_LOG_DEBUG("bound ", instance->fullName(), " id=", tag.id, " to slot ", slot);
+        }
+
+        // bind to the control's slot in the render plan (first, so the control can find its tag's static
+        // fragments by slot) and set the associated node pointer
+        instance->_renderSlot = slot;
+        _controls[slot] = instance;
+        instance->fromHtmlNode(_template->ControlNode(slot), _template->Data());
+        if (instance->RendersViewState())
+            _viewStateSlot = slot;
+        controlChanged(slot);
+        --_unbound;
+    }
+
+    _autosCreated = true;
+    GRIDIRON_LOG_TRACE("bound ", _htmlFile, ", ", _unbound, " control slots left");
+}
+
+// render the page by running the template's render plan: literals are copied straight out of the
+// shared template, control and variable slots were bound by bind(). No tree walking, no lookups.
+// NOTE: if a custom control can have children, it's up to that control to implement the recursive rendering
+void Page::render(std::string &data)
+{
+    if (_template == nullptr)
+        throw GridException(104, "render called when front-end page not given or empty");
+    bind();
 
-    // now get the htmlcxx parse tree of the page if we need it
-    if (firstpass)
+    if (cached(*this))
     {
-        htmlcxx::HTML::ParserDom parser;
-        parser.parse(_data.toStdString());
-        _tree = parser.getTree();
+        data.append(*renderCached(*this));
+        return;
     }
+    renderPlan(data);
+}
+
+void Page::renderPlan(std::string &data)
+{
+    // reserve what pages from this template have been coming out at (the template itself, the first time)
+    const size_t start = data.size();
+    data.reserve(start + std::max(_template->Data().size(), _template->OutputSize().Predict()));
 
-    std::cerr << std::endl
-              << (firstpass ? "First " : "Second ") << "parsing pass starting" << std::endl;
+    WaitReady();
 
-    // now go through the tags on the page looking only for gridiron auto tags at instantiation
-    // if not firstpass, ignore autos and look for regular tags, then search instantiated controls for one with the correct id
-    tree<htmlnode>::iterator it = _tree.begin();
-    tree<htmlnode>::iterator end = _tree.end();
-    while (it != end)
+    // slow independent controls render all at once up front, then everything is stitched together in order
+    std::vector<size_t> parallel;
+    std::vector<std::string> rendered;
+    renderIndependent(parallel, rendered);
+
+    const render_plan plan = _template->Plan();
+    size_t next = 0;
+    for (size_t i = 0; i < plan.size(); ++i)
+    {
+        const RenderOp &op = plan[i];
+        if (op.type == RenderOpType::Literal)
+            data.append(op.text.data(), op.text.size());
+        else if (next < parallel.size() && parallel[next] == i)
+            data.append(rendered[next++]);
+        else
+            renderSlot(op, data);
+    }
+    _template->OutputSize().Record(data.size() - start);
+    GRIDIRON_LOG_TRACE("rendered ", _htmlFile, ", ", data.size() - start, " bytes");
+}
+
+// the page's own state is only read while these run: the controls were bound beforehand, the output cache locks
+void Page::renderIndependent(std::vector<size_t> &ops, std::vector<std::string> &rendered)
+{
+    const render_plan plan = _template->Plan();
+    for (size_t i = 0; i < plan.size(); ++i)
     {
-        // tags we're interested in are <gridiron::* id="foo"></gridiron::*>
-        // a quirk of htmlcxx is helpful to us, tagName only has up to the ::'s
+        const RenderOp &op = plan[i];
+        if (op.type == RenderOpType::Control && _controls[op.slot] != nullptr && _controls[op.slot]->RenderIndependent())
+            ops.push_back(i);
+    }
+    if (ops.size() < 2)
+    {
+        ops.clear();
+        return;
+    }
+
+    rendered.resize(ops.size());
+    RenderPool::Instance().ForEach(ops.size(), [this, &plan, &ops, &rendered](size_t i)
+                                   { renderSlot(plan[ops[i]], rendered[i]); });
+    GRIDIRON_LOG_TRACE("rendered ", ops.size(), " independent controls of ", _htmlFile, " in parallel");
+}
+
+// a postback's output is that user's (their ViewState, what they typed) and the key can't tell it apart, so it
+// neither comes from the output cache nor goes into it
+bool Page::cached(const Control &control) const
+{
+    return control.GetOutputCache() != nullptr && !_isPostBack;
+}
 
-        // if the current element is a Tag (not a comment, etc)
-        // and it's one we're supposed to interpret:
-        if (it->isTag())
+void Page::renderSlot(const RenderOp &op, std::string &data)
+{
+    switch (op.type)
+    {
+    case RenderOpType::Control:
+        // if we found the control associated with this slot, tell it to render
+        // otherwise, print an error in its place
+        if (_controls[op.slot] != nullptr)
+        {
+            if (cached(*_controls[op.slot]))
+                data.append(*renderCached(*_controls[op.slot]));
+            else
+                _controls[op.slot]->render(data);
+        }
+        else
         {
-            std::string tagType = getGridIronCustomControlName(it->tagName());
-            if (!tagType.empty())
+            GRIDIRON_LOG_DEBUG(_htmlFile, ": no instance bound to control slot ", op.slot);
+            data.append("<!-- ERROR rendering control: no instance found -->");
+        }
+        break;
+    case RenderOpType::Value:
+        if (_values[op.slot] != nullptr)
+            data.append(*_values[op.slot]);
+        break;
+    case RenderOpType::Literal:
+        data.append(op.text.data(), op.text.size());
+        break;
+    case RenderOpType::Flush:
+        break; // only means something to a PageReader
+    }
+}
+
+const std::string &Page::Refresh()
+{
+    if (_template == nullptr)
+        throw GridException(104, "render called when front-end page not given or empty");
+    bind();
+    WaitReady();
+
+    const render_plan plan = _template->Plan();
+    if (!_retainedValid)
+    {
+        // the first time, render everything and remember where each slot's output went.
+        // anything marked dirty while we're at it is picked up by the next call
+        _anyDirty.store(false, std::memory_order_relaxed);
+        for (std::atomic<bool> &dirty : _dirtyControls)
+            dirty.store(false, std::memory_order_relaxed);
+        for (std::atomic<bool> &dirty : _dirtyValues)
+            dirty.store(false, std::memory_order_relaxed);
+        _retained.clear();
+        _retained.reserve(std::max(_template->Data().size(), _template->OutputSize().Predict()));
+        _spans.clear();
+        std::vector<size_t> parallel;
+        std::vector<std::string> rendered;
+        renderIndependent(parallel, rendered);
+        size_t next = 0;
+        for (size_t i = 0; i < plan.size(); ++i)
+        {
+            const RenderOp &op = plan[i];
+            if (op.type == RenderOpType::Literal)
             {
-                // get the full Tag string
-                std::string tagData = it->text();
-
-                // use the htmlcxx parsing routine to get all of the attributes and values
-                it->parseAttributes();
-
-                // the first part of the result pair indicates whether the attribute was found
-                // the second has the actual id, if present
-                std::pair<bool, std::string> idresult = it->attribute("id");
-                if (!idresult.first)
-                {
-                    std::cerr << "ERROR: Control Tag is missing id" << std::endl;
-                }
-                else
-                {
-                    // same story here, bool will be true if Tag contained auto
-                    std::pair<bool, std::string> autoresult = it->attribute("auto");
-                    bool isauto = (autoresult.first && (autoresult.second == "true"));
-
-                    // look for any controls on the page with specified ID
-                    Control *instance = FindByID(idresult.second);
-
-                    // if we found an auto Tag and it's the first pass, and the id was already registered (earlier in the while loop, by another Tag)
-                    if ((instance != NULL) && isauto && firstpass)
-                    {
-                        std::cerr << "found auto Tag (" << tagData
-                                  << ") and the specified ID was already in use by a control of type "
-                                  << instance->fullName() << std::endl;
-
-                        // if we found a standard Tag, the id was registered (as it should be, by the client code) and it's not the first pass
-                    }
-                    else if ((instance != NULL) && !isauto && !firstpass)
-                    {
-                        std::cerr << "found Tag (" << tagData << ") and instance with type " << instance->fullName()
-                                  << ", id=" << idresult.second << std::endl;
-
-                        // make sure the instance with that ID is the same type as the control Tag
-                        if (!(Control::instanceOf<Control>(instance)))
-                        {
-                            std::cerr << "ERROR: instance with that id is not a " << tagType << std::endl;
-                        }
-                        else
-                        {
-                            // if it's the right type and id, but it already has an html node associated, we've already seen this Tag in the file- duplicate
-                            if (instance->HTMLNodeRegistered())
-                            {
-                                std::cerr << "Control instance already bound to another Tag." << std::endl;
-
-                                // otherwise, we've found the instance that's supposed to match this Tag
-                            }
-                            else
-                            {
-                                std::cerr << "Control Tag and instance match up." << std::endl;
-                                // set the associated node pointer
-                                instance->SetHTMLNode(&(*it));
-                                // add to nodemap
-                                _nodemap[&(*it)] = instance;
-                                // count how many controls we found
-                                controlcount++;
-                            }
-                        }
-
-                        // if we found an auto Tag on the first pass and no one is using the specified id (at this point instance is guaranteed == NULL, given the other two)
-                        // we've previously handled (instance != NULL, auto, firstpass) and (instance != NULL, !auto, !firstpass)
-                        // if auto and firstpass, instance has to be NULL- meaning the Tag's requested id is available
-                    }
-                    else if (isauto && firstpass)
-                    {
-                        std::cerr << "found auto Tag, specified ID is available" << std::endl;
-
-                        // try to create a control of this type. The control class must be registered with the factory.
-                        // only classes that support autos should register.
-                        instance = globalControlFactory.CreateByType(tagType.c_str(), idresult.second.c_str(),
-                                                                     (Control *)this);
-
-                        // If we get an instance, it worked, if it didn't tough luck.
-                        if (instance == NULL)
-                        {
-                            std::cerr << "unable to create autonomous control of type " << tagType << std::endl;
-                        }
-                        else
-                        {
-                            std::cerr << "autonomous Tag of type=" << tagType << ", id=" << idresult.second
-                                      << " was created." << std::endl;
-                            // set the associated node pointer
-                            instance->SetHTMLNode(&(*it));
-                            // add to nodemap
-                            _nodemap[&(*it)] = instance;
-                            // add to the count of registered controls
-                            controlcount++;
-                        }
-
-                        // if still auto Tag, by elimination, this isn't the first pass- we're not interested. No error here.
-                    }
-                    else if (isauto)
-                    {
-                        std::cerr << "found auto Tag, skipping for second pass" << std::endl;
-                    }
-                }
+                _retained.append(op.text.data(), op.text.size());
+                continue;
             }
+            if (op.type == RenderOpType::Flush)
+                continue;
+            const size_t offset = _retained.size();
+            if (next < parallel.size() && parallel[next] == i)
+                _retained.append(rendered[next++]);
+            else
+                renderSlot(op, _retained);
+            _spans.push_back(RetainedSpan{i, offset, _retained.size() - offset});
+        }
+        _retainedValid = true;
+    }
+    else if (_anyDirty.exchange(false, std::memory_order_acquire))
+    {
+        // re-render just the dirty slots. Output that kept its length is overwritten in place,
+        // anything else moves what follows it along.
+        // take the flags first, a slot can be used more than once. Marked from here on, it's for the next call.
+        std::vector<bool> dirtyControls(_dirtyControls.size());
+        std::vector<bool> dirtyValues(_dirtyValues.size());
+        for (size_t slot = 0; slot < _dirtyControls.size(); ++slot)
+            dirtyControls[slot] = _dirtyControls[slot].exchange(false, std::memory_order_acquire);
+        for (size_t slot = 0; slot < _dirtyValues.size(); ++slot)
+            dirtyValues[slot] = _dirtyValues[slot].exchange(false, std::memory_order_acquire);
+
+        RenderBuffer fragment;
+        size_t patched = 0;
+        ptrdiff_t shift = 0;
+        for (RetainedSpan &span : _spans)
+        {
+            span.offset += shift;
+            const RenderOp &op = plan[span.op];
+            const bool dirty = (op.type == RenderOpType::Control) ? dirtyControls[op.slot] : dirtyValues[op.slot];
+            if (!dirty)
+                continue;
+
+            fragment.String().clear();
+            renderSlot(op, fragment.String());
+            _retained.replace(span.offset, span.length, fragment.String());
+            shift += static_cast<ptrdiff_t>(fragment.Size()) - static_cast<ptrdiff_t>(span.length);
+            span.length = fragment.Size();
+            ++patched;
         }
-        ++it;
+        GRIDIRON_LOG_TRACE("refreshed ", _htmlFile, ", ", patched, " of ", _spans.size(), " slots re-rendered");
     }
-    std::cerr << (firstpass ? "First " : "Second ") << "parsing pass complete." << std::endl
-              << std::endl;
+
+    return _retained;
 }
 
-// helper class to output recursively render all tags we're in control of and output the stuff in the template inbetween
-// called by render
-void Page::renderNode(tree<htmlnode>::sibling_iterator *thisnode, int level, folly::fbstring &data)
+std::string Page::SerializeViewState()
 {
-    tree<htmlnode>::sibling_iterator sib = thisnode->begin();
-    while (sib != thisnode->end())
+    ViewStateWriter writer;
+    _registry.ForEach([&writer](Control *control)
+                      {
+                          if (!control->_viewStateEnabled)
+                              return;
+                          writer.BeginControl(control->ID());
+                          control->SaveViewState(writer);
+                      });
+    return writer.Empty() ? std::string() : writer.Finish(ViewState::Key(), viewStateScope());
+}
+
+// tokens are tied to the front page, one page's ViewState doesn't authenticate on another
+const std::string &Page::viewStateScope() const
+{
+    return _htmlFilepath.empty() ? _htmlFile : _htmlFilepath;
+}
+
+bool Page::RestoreViewState(std::string_view token)
+{
+    ViewState state;
+    if (!state.Parse(token, ViewState::Key(), viewStateScope()))
     {
-        htmlnode *tmpnode = &(sib.node->data);
+        GRIDIRON_LOG_WARN(_htmlFile, ": ViewState did not authenticate, ignored");
+        return false;
+    }
 
-        if (tmpnode->isTag() && (tmpnode->tagName() == Page::_namespace))
-        {
-            // retrieve the control instance using the html node instance
-            Control *tmpcontrol = _nodemap[tmpnode];
+    // controls the page doesn't have (any more), or that no longer keep state, are skipped
+    for (const ViewStateControl &saved : state.Controls())
+    {
+        Control *control = _registry.Find(saved.id);
+        if (control == nullptr || !control->_viewStateEnabled)
+            continue;
+        control->LoadViewState(saved);
+        control->_viewStateValid = true;
+    }
+    return true;
+}
 
-            // if we found the control associated with this node, tell it to render
-            // otherwise, print an error in its place
-            if (tmpcontrol != NULL)
-                tmpcontrol->render(data);
-            else
-                data.append("<!-- ERROR rendering control: no instance found -->");
+// returns false for a bad ViewState, but the fields are still loaded: the controls just don't get their state back
+bool Page::ProcessPostBack(const FormData &form)
+{
+    if (_template != nullptr)
+        bind(); // code-beside controls made since the constructor are found by id too
+    _isPostBack = true;
+
+    const std::string_view token = form.Get(ViewStateField);
+    const bool authentic = token.empty() || RestoreViewState(token);
+
+    // one pass over the fields, only collecting the events
+    std::vector<Control *> changed;
+    Control *sender = nullptr;
+    std::string_view argument;
+    form.ForEach([&](std::string_view name, std::string_view value)
+                 {
+                     if (name.size() >= 2 && name[0] == '_' && name[1] == '_')
+                         return; // ours, not a control's
+                     Control *control = _registry.Find(name);
+                     if (control == nullptr)
+                         return;
+                     if (control->RaisesPostBackEvents())
+                     {
+                         // only the button that was pressed is posted, the first one wins if someone forges more
+                         if (sender == nullptr)
+                         {
+                             sender = control;
+                             argument = value;
+                         }
+                     }
+                     else if (control->LoadPostData(value))
+                     {
+                         changed.push_back(control);
+                     }
+                 });
+
+    // a script-driven postback names its sender. Only a control that sends forms can be named, or a forged
+    // field could put a label in place of the button that was actually pressed.
+    const std::string_view target = form.Get(EventTargetField);
+    if (!target.empty())
+    {
+        Control *control = _registry.Find(target);
+        if (control != nullptr && control->RaisesPostBackEvents())
+        {
+            sender = control;
+            argument = form.Get(EventArgumentField);
         }
-        else
+    }
+
+    // then raise them, changes first so the sender's handler sees the page as posted
+    for (Control *control : changed)
+        control->RaisePostDataChanged();
+    if (sender != nullptr)
+        sender->RaisePostBackEvent(argument);
+
+    GRIDIRON_LOG_DEBUG(_htmlFile, ": postback, ", form.Count(), " fields, ", changed.size(), " changed",
+                       (sender != nullptr) ? ", sent by " : "", (sender != nullptr) ? sender->ID() : std::string());
+    return authentic;
+}
+
+bool Page::Ready() const
+{
+    for (const Control *control : _controls)
+    {
+        if (control != nullptr && !control->ReadyToRender())
+            return false;
+    }
+    return true;
+}
+
+void Page::WaitReady()
+{
+    if (Ready())
+        return;
+    GRIDIRON_LOG_DEBUG(_htmlFile, ": waiting for controls to be ready to render");
+    std::unique_lock<std::mutex> lock(_readyLock);
+    _readyChanged.wait(lock, [this]
+                       { return Ready(); });
+}
+
+void Page::SetReadyListener(std::function<void()> listener)
+{
+    std::lock_guard<std::mutex> lock(_readyLock);
+    _readyListener = std::move(listener);
+}
+
+// under the lock, so a listener being taken away is never called after SetReadyListener returns
+void Page::controlReady()
+{
+    std::lock_guard<std::mutex> lock(_readyLock);
+    _readyChanged.notify_all();
+    if (_readyListener)
+        _readyListener();
+}
+
+void Page::controlChanged(size_t slot)
+{
+    _dirtyControls[slot].store(true, std::memory_order_release);
+    if (_viewStateSlot != NoSlot)
+        _dirtyControls[_viewStateSlot].store(true, std::memory_order_release);
+    _anyDirty.store(true, std::memory_order_release);
+}
+
+// a variable can be shown by more than one Value tag name (and slot)
+void Page::VariableChanged(const std::string *data)
+{
+    for (size_t slot = 0; slot < _values.size(); ++slot)
+    {
+        if (_values[slot] == data)
         {
-            // otherwise, stick in the html
-            data.append(sib->text());
-            // any children of this node
-            if (sib->isTag())
-                renderNode(&sib, level + 1, data);
-            // and the stuff after
-            data.append(sib->closingText());
+            _dirtyValues[slot].store(true, std::memory_order_release);
+            _anyDirty.store(true, std::memory_order_release);
         }
+    }
+}
 
-        ++sib; // next!
+std::shared_ptr<const std::string> Page::renderCached(Control &control)
+{
+    std::string key;
+    outputCacheKey(control, key);
+    if (std::shared_ptr<const std::string> cached = OutputCache::Instance().Get(key))
+        return cached;
+
+    // built in a reused buffer, the cached copy is allocated once at its final size
+    RenderBuffer output;
+    if (&control == this)
+        renderPlan(output.String());
+    else
+        control.render(output.String());
+    auto rendered = std::make_shared<const std::string>(output.String());
+    OutputCache::Instance().Put(key, rendered, control.GetOutputCache()->duration);
+    return rendered;
+}
+
+// one line each for the front page, the id and every vary-by name (with its value, unless it isn't set)
+void Page::outputCacheKey(const Control &control, std::string &key)
+{
+    const OutputCachePolicy &policy = *control.GetOutputCache();
+    key.append(_htmlFilepath).push_back('\n');
+    key.append(control.ID()).push_back('\n');
+    for (const std::string &name : policy.varyByVariables)
+    {
+        key.append("v:").append(name);
+        if (const std::string *value = GetVariable(name))
+            key.append("=").append(*value);
+        key.push_back('\n');
+    }
+    for (const std::string &name : policy.varyByParams)
+    {
+        key.append("q:").append(name);
+        if (const std::string *value = GetQueryParameter(name))
+            key.append("=").append(*value);
+        key.push_back('\n');
     }
 }
 
-// NOTE: if a custom control can have children, it's up to that control to implement the recursive rendering
-std::ostream &operator<<(std::ostream &os, const Control &control)
+std::ostream &GridIron::operator<<(std::ostream &os, Page &page)
 {
-    int lastpos = 0, startpos = 0, endpos = -1, testpos = -1, i = 0;
-    bool replace = false;
-    std::string *datacontents;
-    var_map::iterator m;
+    RenderBuffer data;
+    page.render(data.String());
+    return os.write(data.String().data(), static_cast<std::streamsize>(data.Size()));
+}
 
-    if (_data.size() == 0)
+PageReader::PageReader(std::shared_ptr<Page> page) : _page(std::move(page))
+{
+    if (_page == nullptr || _page->_template == nullptr)
         throw GridException(104, "render called when front-end page not given or empty");
-    this->Page::parse(); // call 2nd pass
+    _plan = _page->_template->Plan();
+}
+
+// like renderIndependent, but without waiting: the pool renders them while we stream out what comes before.
+// Controls that aren't ready yet render inline when they're reached, a worker shouldn't wait on their data.
+void PageReader::startParallel()
+{
+    for (size_t i = 0; i < _plan.size(); ++i)
+    {
+        const RenderOp &op = _plan[i];
+        if (op.type != RenderOpType::Control)
+            continue;
+        const Control *control = _page->_controls[op.slot];
+        if (control != nullptr && control->RenderIndependent() && control->ReadyToRender())
+            _parallelOps.push_back(i);
+    }
+    if (_parallelOps.empty())
+        return;
+
+    _rendered.resize(_parallelOps.size());
+    _renderErrors.resize(_parallelOps.size());
+    _renderDone = std::make_unique<std::atomic<bool>[]>(_parallelOps.size());
+    for (size_t i = 0; i < _parallelOps.size(); ++i)
+        _renderDone[i].store(false, std::memory_order_relaxed);
+
+    _parallel = RenderPool::Instance().Start(_parallelOps.size(), [this](size_t i)
+                                             {
+                                                 try
+                                                 {
+                                                     _page->renderSlot(_plan[_parallelOps[i]], _rendered[i]);
+                                                 }
+                                                 catch (...)
+                                                 {
+                                                     _renderErrors[i] = std::current_exception();
+                                                 }
+                                                 _renderDone[i].store(true, std::memory_order_release);
+                                                 _page->controlReady(); // wake a reader waiting on it
+                                             });
+}
+
+bool PageReader::next()
+{
+    if (_op == _plan.size())
+        return false;
+
+    // rendered on the pool, if it's finished
+    if (_nextParallel < _parallelOps.size() && _parallelOps[_nextParallel] == _op)
+    {
+        const size_t i = _nextParallel;
+        if (!_renderDone[i].load(std::memory_order_acquire))
+        {
+            _waiting = true;
+            return false;
+        }
+        ++_op;
+        ++_nextParallel;
+        if (_renderErrors[i])
+            std::rethrow_exception(_renderErrors[i]);
+        _pending = _rendered[i];
+        return true;
+    }
+
+    const RenderOp &op = _plan[_op];
+    if (op.type == RenderOpType::Control && _page->_controls[op.slot] != nullptr &&
+        !_page->_controls[op.slot]->ReadyToRender())
+    {
+        // what's before it can go out, it has to wait
+        _waiting = true;
+        return false;
+    }
+    ++_op;
+
+    if (op.type == RenderOpType::Literal)
+    {
+        // served by reference from the template
+        _pending = op.text;
+    }
+    else if (op.type == RenderOpType::Value && _page->_values[op.slot] != nullptr)
+    {
+        // and variables by reference from wherever they live
+        _pending = *_page->_values[op.slot];
+    }
+    else if (op.type == RenderOpType::Control && _page->_controls[op.slot] != nullptr &&
+             _page->cached(*_page->_controls[op.slot]))
+    {
+        // cached fragments by reference from the cache
+        _cached = _page->renderCached(*_page->_controls[op.slot]);
+        _pending = *_cached;
+    }
+    else
+    {
+        _scratch.clear();
+        _page->renderSlot(op, _scratch);
+        _pending = _scratch;
+    }
+    return true;
+}
 
-    // assemble page: start by rendering the first node.
-    tree<htmlnode>::sibling_iterator sib = _tree.begin();
-    renderNode(&sib, 1, data);
-    return os;
+void PageReader::Wait()
+{
+    if (!_waiting)
+        return;
+    if (_nextParallel < _parallelOps.size() && _parallelOps[_nextParallel] == _op)
+    {
+        // rendering on the pool, its task wakes the page's waiters once it's done
+        std::unique_lock<std::mutex> lock(_page->_readyLock);
+        _page->_readyChanged.wait(lock, [this]
+                                  { return _renderDone[_nextParallel].load(std::memory_order_acquire); });
+        return;
+    }
+    _page->WaitReady();
+}
+
+size_t PageReader::Read(char *buffer, size_t count)
+{
+    if (!_started)
+    {
+        _page->bind(); // before the first byte goes out
+        _started = true;
+        _wholePage = _page->cached(*_page);
+        if (!_wholePage)
+            startParallel();
+    }
+
+    _waiting = false;
+    if (_wholePage)
+    {
+        if (!_page->Ready())
+        {
+            _waiting = true;
+            return 0;
+        }
+
+        // a cached page goes out in one piece, the plan isn't run
+        _cached = _page->renderCached(*_page);
+        _pending = *_cached;
+        _op = _plan.size();
+        _wholePage = false;
+    }
+
+    size_t written = 0;
+    while (written < count)
+    {
+        if (_pending.empty())
+        {
+            // at a flush point, what we have goes out now rather than waiting on what comes after
+            if (_op < _plan.size() && _plan[_op].type == RenderOpType::Flush)
+            {
+                ++_op;
+                if (written > 0)
+                    break;
+                continue;
+            }
+            if (!next())
+                break;
+        }
+
+        const size_t n = std::min(count - written, _pending.size());
+        std::memcpy(buffer + written, _pending.data(), n);
+        _pending.remove_prefix(n);
+        written += n;
+    }
+    return written;
 }
 
 // for controls to make variables available for HTML replacement. alphanumeric and _ only.
-bool Page::RegisterVariable(const std::string name, std::string *data)
+// names the template uses were given a slot when it was compiled, those are bound straight into the slot
+// and never looked up again. anything else is kept by name, for GetVariable.
+bool Page::RegisterVariable(const std::string &name, std::string *data)
 {
     // NOTE: tags starting with __ should be system generated vars only, but we won't check
 
@@ -346,18 +762,37 @@ bool Page::RegisterVariable(const std::string name, std::string *data)
         return false;
 
     // validate name characters
-    int pos = name.find_first_not_of("_-abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789."); // allow dots
-    if (pos != std::string::npos)
+    if (name.find_first_not_of("_-abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789.") != std::string::npos) // allow dots
         return false;
 
-    // search through variables, make sure name isn't already registered
-    for (var_map::iterator m = _regvars.begin(); m != _regvars.end(); ++m)
-    {
-        if (m->first == name)
-            return false;
-    }
+    const size_t slot = (_template != nullptr) ? _template->ValueSlot(name) : Template::npos;
+    if (slot == Template::npos)
+        return _regvars.emplace(name, data).second; // false if the name is already registered
 
-    // no existing var with same name found, register it
-    _regvars[name] = data;
+    if (_values[slot] != nullptr)
+        return false;
+    _values[slot] = data;
+    _dirtyValues[slot].store(true, std::memory_order_release);
+    _anyDirty.store(true, std::memory_order_release);
     return true;
 }
+
+void Page::SetQueryParameter(const std::string &name, std::string value)
+{
+    _query[name] = std::move(value);
+}
+
+const std::string *Page::GetQueryParameter(const std::string &name) const
+{
+    auto it = _query.find(name);
+    return (it == _query.end()) ? nullptr : &it->second;
+}
+
+std::string *Page::GetVariable(const std::string &name)
+{
+    const size_t slot = (_template != nullptr) ? _template->ValueSlot(name) : Template::npos;
+    if (slot != Template::npos)
+        return _values[slot];
+    var_map::iterator m = _regvars.find(name);
+    return (m == _regvars.end()) ? nullptr : m->second;
+}
@@ -0,0 +1,147 @@
+/****************************************************************************************
+ * (C) Copyright 2009-2024
+ *    Jessica Mulein <jessica@digitaldefiance.org>
+ *    Digital Defiance and Contributors <https://digitaldefiance.org>
+ *
+ * Others will be credited if more developers join.
+ *
+ * License
+ *
+ * This code is licensed under the Apache license.
+ * Please see COPYING in the root of this package for details.
+ *
+ * The following libraries are only linked in, and no code is based directly from them:
+ * htmlcxx is under the Apache 2.0 License
+ ***************************************************************************************
+ * ControlRegistry Class
+ * ---------------------
+ *
+ * Per-page id -> control index. See registry.hpp.
+ ***************************************************************************************/
+
+#include <functional>
+#include <gridiron/controls/registry.hpp>
+#include <gridiron/controls/control.hpp>
+
+namespace GridIron
+{
+    static char tombstoneMarker;
+    Control *const ControlRegistry::Tombstone = reinterpret_cast<Control *>(&tombstoneMarker);
+
+    ControlRegistry::ControlRegistry()
+        : _resource(_inline, sizeof(_inline)), _slots(InitialCapacity, Slot{0, nullptr}, &_resource)
+    {
+    }
+
+    void *ControlRegistry::inlineResource::do_allocate(size_t bytes, size_t alignment)
+    {
+        if (!_inUse && bytes <= _size && alignment <= alignof(Slot))
+        {
+            _inUse = true;
+            return _buffer;
+        }
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void ControlRegistry::inlineResource::do_deallocate(void *p, size_t bytes, size_t alignment)
+    {
+        if (p == _buffer)
+            _inUse = false;
+        else
+            std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+
+    // linear probe from the hash. Returns the slot holding id, or the first empty slot if it isn't there.
+    // tombstones are skipped, never returned: the caller reuses them on insert.
+    size_t ControlRegistry::probe(std::string_view id, size_t hash) const
+    {
+        const size_t mask = _slots.size() - 1;
+        size_t i = hash & mask;
+        while (true)
+        {
+            const Slot &slot = _slots[i];
+            if (slot.control == nullptr)
+                return i;
+            if (slot.control != Tombstone && slot.hash == hash && slot.control->ID() == id)
+                return i;
+            i = (i + 1) & mask;
+        }
+    }
+
+    bool ControlRegistry::Register(Control *control)
+    {
+        if (control == nullptr || control->ID().empty())
+            return false;
+
+        // keep the load (including tombstones) under 3/4 so probes stay short and always terminate
+        if ((_used + 1) * 4 > _slots.size() * 3)
+            grow();
+
+        const std::string_view id = control->ID();
+        const size_t hash = std::hash<std::string_view>()(id);
+        const size_t i = probe(id, hash);
+        if (_slots[i].control != nullptr)
+            return false; // id already in use
+
+        // prefer a tombstone earlier in the chain over the empty slot we stopped at
+        const size_t mask = _slots.size() - 1;
+        size_t target = i;
+        for (size_t j = hash & mask; j != i; j = (j + 1) & mask)
+        {
+            if (_slots[j].control == Tombstone)
+            {
+                target = j;
+                break;
+            }
+        }
+
+        if (_slots[target].control == nullptr)
+            _used++;
+        _slots[target] = Slot{hash, control};
+        _count++;
+        return true;
+    }
+
+    bool ControlRegistry::Unregister(Control *control)
+    {
+        if (control == nullptr)
+            return false;
+
+        const std::string_view id = control->ID();
+        const size_t i = probe(id, std::hash<std::string_view>()(id));
+        if (_slots[i].control != control)
+            return false;
+
+        _slots[i].control = Tombstone;
+        _count--;
+        return true;
+    }
+
+    Control *ControlRegistry::Find(std::string_view id) const
+    {
+        const size_t i = probe(id, std::hash<std::string_view>()(id));
+        return _slots[i].control;
+    }
+
+    // double the table (or just rehash if it's mostly tombstones). The old table is freed once its entries are moved.
+    void ControlRegistry::grow()
+    {
+        const size_t capacity = (_count * 2 >= _slots.size()) ? _slots.size() * 2 : _slots.size();
+        std::pmr::vector<Slot> old(&_resource);
+        old.swap(_slots);
+        _slots.assign(capacity, Slot{0, nullptr});
+        _used = 0;
+
+        const size_t mask = capacity - 1;
+        for (const Slot &slot : old)
+        {
+            if (slot.control == nullptr || slot.control == Tombstone)
+                continue;
+            size_t i = slot.hash & mask;
+            while (_slots[i].control != nullptr)
+                i = (i + 1) & mask;
+            _slots[i] = slot;
+            _used++;
+        }
+    }
+}
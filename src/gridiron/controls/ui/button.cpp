@@ -0,0 +1,89 @@
+/****************************************************************************************
+ * (C) Copyright 2009-2024
+ *    Jessica Mulein <jessica@digitaldefiance.org>
+ *    Digital Defiance and Contributors <https://digitaldefiance.org>
+ *
+ * Others will be credited if more developers join.
+ *
+ * License
+ *
+ * This code is licensed under the Apache license.
+ * Please see COPYING in the root of this package for details.
+ *
+ * The following libraries are only linked in, and no code is based directly from them:
+ * htmlcxx is under the Apache 2.0 License
+ ***************************************************************************************
+ * GridIron::Button custom control class
+ * -------------------------------------
+ *
+ * A submit button, raises OnClick when it posted the form
+ ***************************************************************************************/
+
+#include <gridiron/controls/control.hpp>
+#include <gridiron/controls/page.hpp>
+#include <gridiron/controls/ui/button.hpp>
+
+using namespace GridIron;
+using namespace GridIron::controls;
+
+Button::Button(std::string id, Control *parent) : Control(id, parent)
+{
+    _defaulttext = true;
+}
+
+Button::Button(std::string id, Control *parent, std::string text) : Control(id, parent), _text(std::move(text))
+{
+    _defaulttext = false;
+}
+
+void Button::SetText(std::string value)
+{
+    _text = std::move(value);
+    _defaulttext = false;
+    MarkDirty();
+}
+
+void Button::fromHtmlNode(const htmlnode &node, std::string_view source)
+{
+    Control::fromHtmlNode(node, source);
+
+    // the template indexed our tag's attributes once, nothing to parse. The default caption is the value attribute,
+    // unless the code-beside already set one.
+    Page *_Page = GetPage();
+    if (_Page != nullptr && _Page->GetTemplate() != nullptr && _renderSlot != NoSlot)
+    {
+        const std::string_view value = _Page->GetTemplate()->Controls()[_renderSlot].Attribute("value");
+        if (_defaulttext)
+            _text.assign(value.data(), value.size());
+        _fragments = &_Page->GetTemplate()->Fragments(_renderSlot, &Button::buildFragments);
+    }
+}
+
+// everything up to the value, which only depends on our id
+void Button::buildFragments(const Template &compiled, size_t slot, StaticFragments &fragments)
+{
+    openTag(fragments.prefix, compiled.Controls()[slot].id);
+}
+
+void Button::openTag(std::string &data, std::string_view id)
+{
+    data.append("<input type=\"submit\" id=\"").append(id.data(), id.size());
+    data.append("\" name=\"").append(id.data(), id.size()).append("\" value=\"");
+}
+
+void Button::render(std::string &data)
+{
+    if (_fragments != nullptr)
+        data.append(_fragments->prefix);
+    else
+        openTag(data, _id);
+    xmlEncode(_text, data);
+    data.append("\" />");
+}
+
+// the browser posts our caption as the value, it's passed on as the argument
+void Button::RaisePostBackEvent(std::string_view argument)
+{
+    if (_onClick)
+        _onClick(*this, argument);
+}
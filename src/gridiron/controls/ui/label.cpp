@@ -27,29 +27,20 @@
 #include <gridiron/controls/control.hpp>
 #include <gridiron/controls/page.hpp>
 #include <gridiron/controls/ui/label.hpp>
+#include <gridiron/renderbuffer.hpp>
 #include <gridiron/tag.hpp>
 
 using namespace GridIron;
 using namespace GridIron::controls;
 
-std::string Label::controlTagName() const
-{
-    return "Label";
-}
-
-std::string Label::renderTagName() const
-{
-    return "div";
-}
-
-Label::Label(std::string id, std::shared_ptr<Control> parent) : Control(id, parent)
+Label::Label(std::string id, Control *parent) : Control(id, parent)
 {
     // nothing extra
     _text = std::string("");
     _defaulttext = true; // text has not been overriden/changed
 }
 
-Label::Label(std::string id, std::shared_ptr<Control> parent, std::string text) : Control(id, parent)
+Label::Label(std::string id, Control *parent, std::string text) : Control(id, parent)
 {
     // copy text
     _text = text;
@@ -60,48 +51,115 @@ Label::~Label()
 {
 }
 
-Label *
-Label::fromHtmlNode(htmlnode &node)
+void Label::SetText(std::string value)
 {
-    std::unique_ptr<Page> _Page = GetPage();
-    if (_Page == nullptr)
-        throw GridException(300, "Control must be attached to a page");
-    if (_htmlNode == nullptr)
-        throw GridException(301, "HTML Tag not found for this instance");
-
-    // if there are child nodes, that will be the text for the label, should not override any text that has already been set.
-    // if _defaulttext == true, can override
-    // a shortcut to the below might be to read the parsed sibling/child
-
-    // only parse the original/default text if we need it (it hasn't been changed)
-    if (_defaulttext)
-    {
+    _text = std::move(value);
+    _defaulttext = false;
 
-        std::string starttag = _htmlNode->text();
-        std::string endtag = _htmlNode->closingText();
+    // we render it, and it may be registered as a variable (ours, as id.Text, or by the code-beside)
+    MarkDirty();
+    if (Page *page = GetPage())
+        page->VariableChanged(&_text);
+}
 
-        _text = data->substr(_htmlNode->offset() + starttag.length(),
-                             _htmlNode->length() - endtag.length() - starttag.length());
+// what's between our opening and closing tags
+static std::string_view tagContents(const htmlnode &node, std::string_view source)
+{
+    const size_t opening = node.text().length();
+    return source.substr(node.offset() + opening, node.length() - node.closingText().length() - opening);
+}
+
+std::string *const Label::GetTextPtr()
+{
+    // from now on the text has to live in _text, where the pointer goes
+    if (!_textShared)
+    {
+        if (_defaulttext)
+            _text.assign(_defaultText.data(), _defaultText.size());
+        _textShared = true;
     }
+    return &_text;
+}
+
+void Label::fromHtmlNode(const htmlnode &node, std::string_view source)
+{
+    Control::fromHtmlNode(node, source);
+
+    // the contents of the tag are the default text, used if the text hasn't been set (_defaulttext == true).
+    // they stay in the shared template, only copied if someone has a pointer to the text.
+    _defaultText = tagContents(node, source);
+    if (_defaulttext && _textShared)
+        _text.assign(_defaultText.data(), _defaultText.size());
+
+    // the parts of our output that only depend on the tag are built once per template, not per request
+    Page *_Page = GetPage();
+    if (_Page != nullptr && _Page->GetTemplate() != nullptr && _renderSlot != NoSlot)
+        _fragments = &_Page->GetTemplate()->Fragments(_renderSlot, &Label::buildFragments);
 
     // if we're an autonomous Tag, automatically register the text string for access
     // otherwise client will have to manually register if they want it accessible
     if (_autonomous)
-        _Page->RegisterVariable(_id + ".Text", &_text);
+    {
+        if (_Page == nullptr)
+            throw GridException(300, "Control must be attached to a page");
+        _Page->RegisterVariable(_id + ".Text", GetTextPtr());
+    }
+}
+
+// the opening tag with the default size, and the encoded default text
+void Label::buildFragments(const Template &compiled, size_t slot, StaticFragments &fragments)
+{
+    openTag(fragments.prefix, compiled.Controls()[slot].id, 0, 0);
+    xmlEncode(tagContents(compiled.ControlNode(slot), compiled.Data()), fragments.body);
+}
+
+void Label::openTag(std::string &data, std::string_view id, int height, int width)
+{
+    data.append("<div style=\"align: left; height: ");
+    appendInteger(data, height).append(" px; width: ");
+    appendInteger(data, width).append(" px; \" id=\"").append(id.data(), id.size()).append("\">");
+}
+
+void Label::render(std::string &data)
+{
+    // what only depends on our tag comes ready made from the template, as long as it still applies
+    if (_fragments != nullptr && _height == 0 && _width == 0)
+        data.append(_fragments->prefix);
+    else
+        openTag(data, _id, _height, _width);
+
+    if (_fragments != nullptr && _defaulttext && (!_textShared || _text == _defaultText))
+        data.append(_fragments->body);
+    else
+        xmlEncode(textView(), data);
+    data.append("</div>");
 }
 
-std::ostream &operator<<(std::ostream &os, Label &label)
+void Label::SaveViewState(ViewStateWriter &writer)
 {
-    label.parse();
-    htmlcxx::HTML::Node n;
-    const char *foo = "<" + this->renderTagName() + " style=\"align: left; height: " + std::to_string(this->_height) + " px; width: " + std::to_string(this->_width) + " px; \" id=\"" + this->id + "\">" + _text.c_str() + "</div>";
-    //    return oatpp::String(foo);
+    // text from the template comes back from the template
+    if (!_defaulttext)
+        writer.Write("Text", _text);
+    if (_height != 0)
+        writer.Write("Height", static_cast<int64_t>(_height));
+    if (_width != 0)
+        writer.Write("Width", static_cast<int64_t>(_width));
+}
 
-    return os;
+void Label::LoadViewState(const ViewStateControl &state)
+{
+    if (state.Has("Text"))
+        SetText(std::string(state.Get("Text")));
+    int64_t value;
+    if (state.GetInt("Height", value))
+        SetHeight(static_cast<int>(value));
+    if (state.GetInt("Width", value))
+        SetWidth(static_cast<int>(value));
 }
 
-////////////////////////////////////////////////////////////
-// Declare an instance of the proxy to register the
-// existence of Label with the ControlFactory
-// !! only do this for classes that support autos !!
-static GridIron::ControlFactoryProxy<GridIron::controls::Label> globalLabelProxy;
+std::ostream &GridIron::controls::operator<<(std::ostream &os, Label &label)
+{
+    RenderBuffer data;
+    label.render(data.String());
+    return os.write(data.String().data(), static_cast<std::streamsize>(data.Size()));
+}
@@ -0,0 +1,124 @@
+/****************************************************************************************
+ * (C) Copyright 2009-2024
+ *    Jessica Mulein <jessica@digitaldefiance.org>
+ *    Digital Defiance and Contributors <https://digitaldefiance.org>
+ *
+ * Others will be credited if more developers join.
+ *
+ * License
+ *
+ * This code is licensed under the Apache license.
+ * Please see COPYING in the root of this package for details.
+ *
+ * The following libraries are only linked in, and no code is based directly from them:
+ * htmlcxx is under the Apache 2.0 License
+ ***************************************************************************************
+ * GridIron::TextBox custom control class
+ * --------------------------------------
+ *
+ * A single line text input that takes its text back on postback
+ ***************************************************************************************/
+
+#include <gridiron/exceptions.hpp>
+#include <gridiron/controls/control.hpp>
+#include <gridiron/controls/page.hpp>
+#include <gridiron/controls/ui/textbox.hpp>
+
+using namespace GridIron;
+using namespace GridIron::controls;
+
+TextBox::TextBox(std::string id, Control *parent) : Control(id, parent)
+{
+    _defaulttext = true; // text has not been overriden/changed
+    _viewStateEnabled = true; // postbacks need the text we sent to tell whether the user changed it
+}
+
+TextBox::TextBox(std::string id, Control *parent, std::string text) : Control(id, parent), _text(std::move(text))
+{
+    _defaulttext = false;
+    _viewStateEnabled = true;
+}
+
+void TextBox::SetText(std::string value)
+{
+    _text = std::move(value);
+    _defaulttext = false;
+
+    MarkDirty();
+    if (Page *page = GetPage())
+        page->VariableChanged(&_text);
+}
+
+void TextBox::fromHtmlNode(const htmlnode &node, std::string_view source)
+{
+    Control::fromHtmlNode(node, source);
+
+    // the template indexed our tag's attributes once, nothing to parse. The default text is the value attribute,
+    // unless the code-beside already set one.
+    Page *_Page = GetPage();
+    if (_Page != nullptr && _Page->GetTemplate() != nullptr && _renderSlot != NoSlot)
+    {
+        const std::string_view value = _Page->GetTemplate()->Controls()[_renderSlot].Attribute("value");
+        if (_defaulttext)
+            _text.assign(value.data(), value.size());
+        _fragments = &_Page->GetTemplate()->Fragments(_renderSlot, &TextBox::buildFragments);
+    }
+
+    // autos get their text registered for access, like labels
+    if (_autonomous)
+    {
+        if (_Page == nullptr)
+            throw GridException(300, "Control must be attached to a page");
+        _Page->RegisterVariable(_id + ".Text", &_text);
+    }
+}
+
+// everything up to the value, which only depends on our id
+void TextBox::buildFragments(const Template &compiled, size_t slot, StaticFragments &fragments)
+{
+    openTag(fragments.prefix, compiled.Controls()[slot].id);
+}
+
+void TextBox::openTag(std::string &data, std::string_view id)
+{
+    data.append("<input type=\"text\" id=\"").append(id.data(), id.size());
+    data.append("\" name=\"").append(id.data(), id.size()).append("\" value=\"");
+}
+
+void TextBox::render(std::string &data)
+{
+    if (_fragments != nullptr)
+        data.append(_fragments->prefix);
+    else
+        openTag(data, _id);
+    xmlEncode(_text, data);
+    data.append("\" />");
+}
+
+void TextBox::SaveViewState(ViewStateWriter &writer)
+{
+    // text from the template comes back from the template
+    if (!_defaulttext)
+        writer.Write("Text", _text);
+}
+
+void TextBox::LoadViewState(const ViewStateControl &state)
+{
+    if (state.Has("Text"))
+        SetText(std::string(state.Get("Text")));
+}
+
+// the ViewState was restored first, so our text is what the client was sent
+bool TextBox::LoadPostData(std::string_view value)
+{
+    if (value == _text)
+        return false;
+    SetText(std::string(value));
+    return true;
+}
+
+void TextBox::RaisePostDataChanged()
+{
+    if (_onTextChanged)
+        _onTextChanged(*this);
+}
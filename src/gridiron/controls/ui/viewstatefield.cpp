@@ -0,0 +1,41 @@
+/****************************************************************************************
+ * (C) Copyright 2009-2024
+ *    Jessica Mulein <jessica@digitaldefiance.org>
+ *    Digital Defiance and Contributors <https://digitaldefiance.org>
+ *
+ * Others will be credited if more developers join.
+ *
+ * License
+ *
+ * This code is licensed under the Apache license.
+ * Please see COPYING in the root of this package for details.
+ *
+ * The following libraries are only linked in, and no code is based directly from them:
+ * htmlcxx is under the Apache 2.0 License
+ ***************************************************************************************
+ * GridIron::ViewStateField custom control class
+ * ---------------------------------------------
+ *
+ * Renders the page's ViewState as the hidden __VIEWSTATE field
+ ***************************************************************************************/
+
+#include <gridiron/controls/control.hpp>
+#include <gridiron/controls/page.hpp>
+#include <gridiron/controls/ui/viewstatefield.hpp>
+
+using namespace GridIron;
+using namespace GridIron::controls;
+
+ViewStateField::ViewStateField(std::string id, Control *parent) : Control(id, parent)
+{
+}
+
+// the token is base64url, nothing in it needs encoding
+void ViewStateField::render(std::string &data)
+{
+    data.append("<").append(renderTagName()).append(" type=\"hidden\" id=\"").append(_id);
+    data.append("\" name=\"").append(Page::ViewStateField).append("\" value=\"");
+    if (Page *page = GetPage())
+        data.append(page->SerializeViewState());
+    data.append("\" />");
+}
@@ -0,0 +1,202 @@
+/****************************************************************************************
+ * (C) Copyright 2009-2024
+ *    Jessica Mulein <jessica@digitaldefiance.org>
+ *    Digital Defiance and Contributors <https://digitaldefiance.org>
+ *
+ * Others will be credited if more developers join.
+ *
+ * License
+ *
+ * This code is licensed under the Apache license.
+ * Please see COPYING in the root of this package for details.
+ *
+ * The following libraries are only linked in, and no code is based directly from them:
+ * htmlcxx is under the Apache 2.0 License
+ ***************************************************************************************
+ * FormData Class
+ * --------------
+ *
+ * Streaming urlencoded form parser. See formdata.hpp.
+ ***************************************************************************************/
+
+#include <gridiron/formdata.hpp>
+
+namespace GridIron
+{
+    static inline int hexValue(char c)
+    {
+        if (c >= '0' && c <= '9')
+            return c - '0';
+        if (c >= 'a' && c <= 'f')
+            return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F')
+            return c - 'A' + 10;
+        return -1;
+    }
+
+    FormData::FormData(size_t maxBody) : _maxBody(maxBody)
+    {
+    }
+
+    bool FormData::Append(std::string_view chunk)
+    {
+        if (_overflowed)
+            return false;
+        _received += chunk.size();
+        if (_received > _maxBody)
+            return overflow();
+        _buffer.append(chunk.data(), chunk.size());
+        parse(false);
+        return !_overflowed;
+    }
+
+    bool FormData::Parse(std::string body)
+    {
+        if (_buffer.empty() && !_overflowed)
+        {
+            _received = body.size();
+            if (_received > _maxBody)
+                return overflow();
+            _buffer = std::move(body);
+        }
+        else if (!Append(body))
+        {
+            return false;
+        }
+        return Finish();
+    }
+
+    bool FormData::Finish()
+    {
+        if (_overflowed)
+            return false;
+        parse(true);
+        return !_overflowed;
+    }
+
+    bool FormData::overflow()
+    {
+        _overflowed = true;
+        _buffer.resize(_decodedEnd); // keep what was decoded, drop the rest
+        _scanned = _decodedEnd;
+        return false;
+    }
+
+    // the fields decoded so far sit at the front of the buffer, the part still to decode follows them. Each field is
+    // decoded only once its '&' has arrived (or the body is done), so an escape is never split across pieces.
+    void FormData::parse(bool final)
+    {
+        size_t raw = _decodedEnd; // start of the next undecoded field
+        while (raw < _buffer.size())
+        {
+            size_t end = _buffer.find('&', (_scanned > raw) ? _scanned : raw);
+            if (end == std::string::npos)
+            {
+                if (!final)
+                {
+                    _scanned = _buffer.size();
+                    break;
+                }
+                end = _buffer.size();
+            }
+
+            if (end > raw)
+            {
+                if (_fields.size() >= MaxFields)
+                {
+                    overflow();
+                    return;
+                }
+                // only look within the field, a body of fields without '=' would otherwise scan to the end each time
+                size_t equals = std::string_view(_buffer).substr(raw, end - raw).find('=');
+                equals = (equals == std::string_view::npos) ? end : raw + equals;
+
+                field entry;
+                entry.name = _decodedEnd;
+                entry.nameLength = decode(raw, equals);
+                entry.value = _decodedEnd;
+                entry.valueLength = (equals < end) ? decode(equals + 1, end) : 0;
+                _fields.push_back(entry);
+            }
+            raw = end + 1;
+        }
+
+        // move the unfinished field (if any) down against the decoded ones
+        if (raw > _buffer.size())
+            raw = _buffer.size();
+        if (raw > _decodedEnd)
+        {
+            _buffer.erase(_decodedEnd, raw - _decodedEnd);
+            _scanned = (_scanned > raw) ? _scanned - (raw - _decodedEnd) : _decodedEnd;
+        }
+        if (final)
+            _scanned = _buffer.size();
+    }
+
+    // decoding only ever shrinks the text, so writing behind the read position is safe.
+    // A '%' that isn't followed by two hex digits is kept as is.
+    size_t FormData::decode(size_t from, size_t to)
+    {
+        char *data = &_buffer[0];
+        size_t out = _decodedEnd;
+
+        // nothing to move until the first escape, or until an earlier field shrank
+        if (out == from)
+        {
+            while (from < to && data[from] != '%' && data[from] != '+')
+                ++from;
+            out = from;
+        }
+
+        for (size_t i = from; i < to; ++i)
+        {
+            char c = data[i];
+            if (c == '+')
+            {
+                c = ' ';
+            }
+            else if (c == '%' && i + 2 < to)
+            {
+                const int high = hexValue(data[i + 1]);
+                const int low = hexValue(data[i + 2]);
+                if (high >= 0 && low >= 0)
+                {
+                    c = static_cast<char>((high << 4) | low);
+                    i += 2;
+                }
+            }
+            data[out++] = c;
+        }
+
+        const size_t length = out - _decodedEnd;
+        _decodedEnd = out;
+        return length;
+    }
+
+    std::pair<std::string_view, std::string_view> FormData::Field(size_t i) const
+    {
+        const field &entry = _fields[i];
+        return {std::string_view(_buffer.data() + entry.name, entry.nameLength),
+                std::string_view(_buffer.data() + entry.value, entry.valueLength)};
+    }
+
+    std::string_view FormData::Get(std::string_view name, std::string_view defaultValue) const
+    {
+        for (const field &entry : _fields)
+        {
+            if (std::string_view(_buffer.data() + entry.name, entry.nameLength) == name)
+                return std::string_view(_buffer.data() + entry.value, entry.valueLength);
+        }
+        return defaultValue;
+    }
+
+    bool FormData::Has(std::string_view name) const
+    {
+        for (const field &entry : _fields)
+        {
+            if (std::string_view(_buffer.data() + entry.name, entry.nameLength) == name)
+                return true;
+        }
+        return false;
+    }
+}
@@ -18,111 +18,72 @@
 #include <gridiron/exceptions.hpp>
 #include <filesystem>
 #include <sstream>
-#include <regex>
 
 namespace GridIron
 {
-    const std::string HtmlNamespace = GRIDIRON_XHTML_NS;
+    // ascii only, no locale lookups
+    static inline bool isNameStart(char c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_'; }
+    static inline bool isNameChar(char c) { return isNameStart(c) || (c >= '0' && c <= '9'); }
+    static inline bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\f'; }
 
-    // parse control type out of Tag
-    std::pair<std::string, std::string> gridironParseTag(std::string tag)
+    // skip the '<' and any whitespace after it, if the tag has them
+    static inline size_t nameStart(std::string_view tag)
     {
-        std::regex rgx("^<\\s*(:alpha:+)::(:alpha:+).*>");
-        std::smatch matches;
-        std::regex_search(tag, matches, rgx);
-        if (matches.size() == 2)
+        size_t i = 0;
+        if (i < tag.size() && tag[i] == '<')
         {
-            return std::make_pair<std::string, std::string>(matches[0], matches[1]);
+            ++i;
+            while (i < tag.size() && isSpace(tag[i]))
+                ++i;
         }
-        return std::make_pair<std::string, std::string>("", "");
+        return i;
     }
 
-    std::string getGridIronCustomControlName(std::string tag)
+    // scan Namespace and Type out of "<Namespace::Type ...>" or a bare "Namespace::Type". No copies, no allocation.
+    std::pair<std::string_view, std::string_view> gridironParseTag(std::string_view tag)
     {
-        auto parsedTag = GridIron::gridironParseTag(tag);
-        // check if the parsed tag is in the gridiron html namespace
-        if (!parsedTag.first.empty() && parsedTag.first == HtmlNamespace && !parsedTag.second.empty())
-        {
-            return parsedTag.second;
-        }
-        return "";
-    }
+        size_t i = nameStart(tag);
 
-    bool isCustomControl(std::string tag)
-    {
-        return !getGridIronCustomControlName(tag).empty();
-    }
+        const size_t nsStart = i;
+        if (i == tag.size() || !isNameStart(tag[i]))
+            return {};
+        while (i < tag.size() && isNameChar(tag[i]))
+            ++i;
+        const size_t nsEnd = i;
 
-    std::ostream &xmlEncode(std::ostream &dest, std::istream &source)
-    {
-        while (!source.eof())
-        {
-            char c = source.peek();
-            switch (c)
-            {
-            case '&':
-                dest << "&amp;";
-                break;
-            case '\"':
-                dest << "&quot;";
-                break;
-            case '\'':
-                dest << "&apos;";
-                break;
-            case '<':
-                dest << "&lt;";
-                break;
-            case '>':
-                dest << "&gt;";
-                break;
-            default:
-                dest << c;
-            }
-        }
-        return dest;
+        if (tag.size() - i < 2 || tag[i] != ':' || tag[i + 1] != ':')
+            return {};
+        i += 2;
+
+        const size_t typeStart = i;
+        if (i == tag.size() || !isNameStart(tag[i]))
+            return {};
+        while (i < tag.size() && isNameChar(tag[i]))
+            ++i;
+
+        // the name has to end there, not run on into something like "GridIron::Label:x"
+        if (i < tag.size() && !isSpace(tag[i]) && tag[i] != '/' && tag[i] != '>')
+            return {};
+
+        return {tag.substr(nsStart, nsEnd - nsStart), tag.substr(typeStart, i - typeStart)};
     }
 
-    std::string xmlEncode(std::string data)
+    std::string_view getGridIronCustomControlName(std::string_view tag)
     {
-        if (data.empty())
-            return data;
+        // almost every tag on a page is plain html, turn those away on the first letter
+        const size_t start = nameStart(tag);
+        if (start == tag.size() || HtmlNamespace.empty() || tag[start] != HtmlNamespace[0])
+            return {};
 
-        size_t pos;
-        size_t minPos = 0;
-        do
-        {
-            pos = data.find_first_of("&\"\'<>", minPos);
-            char c = data[pos];
-            switch (c)
-            {
-            case '&':
-                data.replace(pos, 1, "&amp;");
-                minPos += 5;
-                break;
-            case '\"':
-                data.replace(pos, 1, "&qout;");
-                minPos += 6;
-                break;
-            case '\'':
-                data.replace(pos, 1, "&apos;");
-                minPos += 7;
-                break;
-            case '<':
-                data.replace(pos, 1, "&lt;");
-                minPos += 4;
-                break;
-            case '>':
-                data.replace(pos, 1, "&gt;");
-                minPos += 4;
-                break;
-            }
-        } while (pos != std::string::npos);
-        return data;
+        auto parsedTag = GridIron::gridironParseTag(tag);
+        // check if the parsed tag is in the gridiron html namespace
+        if (parsedTag.first == HtmlNamespace)
+            return parsedTag.second;
+        return {};
     }
 
-    std::ostream &xmlEncode(std::string data, std::ostream &os)
+    bool isCustomControl(std::string_view tag)
     {
-        os << xmlEncode(data);
-        return os;
+        return !getGridIronCustomControlName(tag).empty();
     }
 }
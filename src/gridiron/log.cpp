@@ -0,0 +1,211 @@
+/****************************************************************************************
+ * (C) Copyright 2009-2024
+ *    Jessica Mulein <jessica@digitaldefiance.org>
+ *    Digital Defiance and Contributors <https://digitaldefiance.org>
+ *
+ * Others will be credited if more developers join.
+ *
+ * License
+ *
+ * This code is licensed under the Apache license.
+ * Please see COPYING in the root of this package for details.
+ *
+ * The following libraries are only linked in, and no code is based directly from them:
+ * htmlcxx is under the Apache 2.0 License
+ ***************************************************************************************
+ * Logger Class
+ * ------------
+ *
+ * Per-thread rings drained by a background thread. See log.hpp.
+ ***************************************************************************************/
+
+#include <gridiron/log.hpp>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+namespace GridIron
+{
+    // how often the drain thread wakes up on its own
+    static constexpr std::chrono::milliseconds DrainInterval(20);
+
+    const char *LogLevelName(LogLevel level)
+    {
+        switch (level)
+        {
+        case LogLevel::Trace:
+            return "TRACE";
+        case LogLevel::Debug:
+            return "DEBUG";
+        case LogLevel::Info:
+            return "INFO";
+        case LogLevel::Warn:
+            return "WARN";
+        case LogLevel::Error:
+            return "ERROR";
+        default:
+            return "OFF";
+        }
+    }
+
+    void LogRecord::append(std::string_view value)
+    {
+        const size_t n = std::min(value.size(), MaxText - length);
+        std::memcpy(text + length, value.data(), n);
+        length += static_cast<uint16_t>(n);
+    }
+
+    void LogRecord::append(const void *value)
+    {
+        char digits[2 + 2 * sizeof(void *) + 1];
+        const int n = std::snprintf(digits, sizeof(digits), "%p", value);
+        append(std::string_view(digits, n > 0 ? static_cast<size_t>(n) : 0));
+    }
+
+    bool LogRing::Push(const LogRecord &record)
+    {
+        const size_t head = _head.load(std::memory_order_relaxed);
+        if (head - _tail.load(std::memory_order_acquire) == Capacity)
+            return false;
+        LogRecord &slot = _records[head & (Capacity - 1)];
+        slot.time = record.time;
+        slot.level = record.level;
+        slot.length = record.length;
+        std::memcpy(slot.text, record.text, record.length); // only the used part
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool LogRing::Pop(LogRecord &record)
+    {
+        const size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail == _head.load(std::memory_order_acquire))
+            return false;
+        const LogRecord &slot = _records[tail & (Capacity - 1)];
+        record.time = slot.time;
+        record.level = slot.level;
+        record.length = slot.length;
+        std::memcpy(record.text, slot.text, slot.length);
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    Logger &Logger::Instance()
+    {
+        static Logger logger;
+        return logger;
+    }
+
+    Logger::Logger() : _sink(&std::cerr)
+    {
+        _thread = std::thread(&Logger::run, this);
+    }
+
+    Logger::~Logger()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_wakeLock);
+            _stopping = true;
+        }
+        _wake.notify_one();
+        _thread.join();
+        Flush();
+    }
+
+    void Logger::SetSink(std::ostream *sink)
+    {
+        std::lock_guard<std::mutex> lock(_drainLock);
+        drain(); // whatever is queued goes to the old sink
+        _sink = sink;
+    }
+
+    void Logger::Flush()
+    {
+        std::lock_guard<std::mutex> lock(_drainLock);
+        drain();
+    }
+
+    // each thread gets its own ring the first time it logs. The logger keeps a reference too,
+    // so records written just before a thread exits still get drained.
+    LogRing &Logger::ring()
+    {
+        thread_local std::shared_ptr<LogRing> local;
+        if (local == nullptr)
+        {
+            local = std::make_shared<LogRing>();
+            std::lock_guard<std::mutex> lock(_ringsLock);
+            _rings.push_back(local);
+        }
+        return *local;
+    }
+
+    void Logger::push(LogRecord &record)
+    {
+        record.time = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+        if (!ring().Push(record))
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void Logger::drain()
+    {
+        std::vector<std::shared_ptr<LogRing>> rings;
+        {
+            std::lock_guard<std::mutex> lock(_ringsLock);
+            rings = _rings;
+        }
+
+        LogRecord record;
+        _batch.clear();
+        for (const std::shared_ptr<LogRing> &r : rings)
+        {
+            while (r->Pop(record))
+            {
+                if (_sink == nullptr)
+                    continue;
+                char prefix[48];
+                const int n = std::snprintf(prefix, sizeof(prefix), "[%llu.%09llu] %-5s ",
+                                            static_cast<unsigned long long>(record.time / 1000000000ull),
+                                            static_cast<unsigned long long>(record.time % 1000000000ull),
+                                            LogLevelName(record.level));
+                _batch.append(prefix, n > 0 ? static_cast<size_t>(n) : 0);
+                _batch.append(record.text, record.length);
+                _batch.push_back('\n');
+            }
+        }
+        if (_sink != nullptr && !_batch.empty())
+        {
+            _sink->write(_batch.data(), static_cast<std::streamsize>(_batch.size()));
+            _sink->flush();
+        }
+
+        // forget rings whose threads have exited (ours is the only reference left), once they're empty
+        rings.clear();
+        std::lock_guard<std::mutex> lock(_ringsLock);
+        for (size_t i = 0; i < _rings.size();)
+        {
+            if (_rings[i].use_count() == 1 && _rings[i]->Empty())
+            {
+                _rings[i] = _rings.back();
+                _rings.pop_back();
+            }
+            else
+            {
+                ++i;
+            }
+        }
+    }
+
+    void Logger::run()
+    {
+        std::unique_lock<std::mutex> wake(_wakeLock);
+        while (!_stopping)
+        {
+            _wake.wait_for(wake, DrainInterval);
+            wake.unlock();
+            Flush();
+            wake.lock();
+        }
+    }
+}
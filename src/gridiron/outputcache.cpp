@@ -0,0 +1,143 @@
+/****************************************************************************************
+ * (C) Copyright 2009-2024
+ *    Jessica Mulein <jessica@digitaldefiance.org>
+ *    Digital Defiance and Contributors <https://digitaldefiance.org>
+ *
+ * Others will be credited if more developers join.
+ *
+ * License
+ *
+ * This code is licensed under the Apache license.
+ * Please see COPYING in the root of this package for details.
+ *
+ * The following libraries are only linked in, and no code is based directly from them:
+ * htmlcxx is under the Apache 2.0 License
+ ***************************************************************************************
+ * OutputCache Class
+ * -----------------
+ *
+ * Sharded LRU of rendered html. See outputcache.hpp.
+ ***************************************************************************************/
+
+#include <gridiron/outputcache.hpp>
+#include <functional>
+
+namespace GridIron
+{
+    // rough bookkeeping per entry: list node, index node, key and string headers
+    static constexpr size_t EntryOverhead = 128;
+
+    OutputCache &OutputCache::Instance()
+    {
+        static OutputCache cache;
+        return cache;
+    }
+
+    OutputCache::Shard &OutputCache::shard(const std::string &key)
+    {
+        return _shards[std::hash<std::string>()(key) & (ShardCount - 1)];
+    }
+
+    std::shared_ptr<const std::string> OutputCache::Get(const std::string &key)
+    {
+        Shard &s = shard(key);
+        std::lock_guard<std::mutex> lock(s.lock);
+
+        auto it = s.index.find(key);
+        if (it == s.index.end())
+        {
+            _misses.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        if (it->second->expires <= std::chrono::steady_clock::now())
+        {
+            erase(s, it->second);
+            _misses.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        // most recently used goes to the front
+        s.lru.splice(s.lru.begin(), s.lru, it->second);
+        _hits.fetch_add(1, std::memory_order_relaxed);
+        return it->second->output;
+    }
+
+    void OutputCache::Put(const std::string &key, std::shared_ptr<const std::string> output, std::chrono::milliseconds duration)
+    {
+        if (output == nullptr || duration.count() <= 0)
+            return;
+
+        const size_t cost = key.size() + output->size() + EntryOverhead;
+        Shard &s = shard(key);
+        std::lock_guard<std::mutex> lock(s.lock);
+
+        auto it = s.index.find(key);
+        if (it != s.index.end())
+            erase(s, it->second);
+
+        // something bigger than a whole shard's share would only push everything else out
+        if (cost > Budget() / ShardCount)
+            return;
+
+        s.lru.push_front(Entry{key, std::move(output), std::chrono::steady_clock::now() + duration, cost});
+        s.index.emplace(s.lru.front().key, s.lru.begin());
+        s.bytes += cost;
+        evict(s);
+    }
+
+    void OutputCache::Invalidate(const std::string &key)
+    {
+        Shard &s = shard(key);
+        std::lock_guard<std::mutex> lock(s.lock);
+        auto it = s.index.find(key);
+        if (it != s.index.end())
+            erase(s, it->second);
+    }
+
+    void OutputCache::Clear()
+    {
+        for (Shard &s : _shards)
+        {
+            std::lock_guard<std::mutex> lock(s.lock);
+            s.index.clear();
+            s.lru.clear();
+            s.bytes = 0;
+        }
+    }
+
+    void OutputCache::SetBudget(size_t bytes)
+    {
+        _budget.store(bytes, std::memory_order_relaxed);
+        for (Shard &s : _shards)
+        {
+            std::lock_guard<std::mutex> lock(s.lock);
+            evict(s);
+        }
+    }
+
+    size_t OutputCache::Size()
+    {
+        size_t total = 0;
+        for (Shard &s : _shards)
+        {
+            std::lock_guard<std::mutex> lock(s.lock);
+            total += s.bytes;
+        }
+        return total;
+    }
+
+    void OutputCache::erase(Shard &shard, std::list<Entry>::iterator entry)
+    {
+        shard.bytes -= entry->cost;
+        shard.index.erase(entry->key);
+        shard.lru.erase(entry);
+    }
+
+    // expired entries aren't looked for, they go when they're next asked for or reach the back
+    void OutputCache::evict(Shard &shard)
+    {
+        const size_t budget = Budget() / ShardCount;
+        while (shard.bytes > budget && !shard.lru.empty())
+            erase(shard, std::prev(shard.lru.end()));
+    }
+}
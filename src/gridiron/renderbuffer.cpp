@@ -0,0 +1,72 @@
+/****************************************************************************************
+ * (C) Copyright 2009-2024
+ *    Jessica Mulein <jessica@digitaldefiance.org>
+ *    Digital Defiance and Contributors <https://digitaldefiance.org>
+ *
+ * Others will be credited if more developers join.
+ *
+ * License
+ *
+ * This code is licensed under the Apache license.
+ * Please see COPYING in the root of this package for details.
+ *
+ * The following libraries are only linked in, and no code is based directly from them:
+ * htmlcxx is under the Apache 2.0 License
+ ***************************************************************************************
+ * RenderBuffer Class
+ * ------------------
+ *
+ * Per-thread pool of render strings. See renderbuffer.hpp.
+ ***************************************************************************************/
+
+#include <gridiron/renderbuffer.hpp>
+#include <vector>
+
+namespace GridIron
+{
+    // the buffers not in use on this thread, largest capacity last
+    static std::vector<std::string> &pool()
+    {
+        thread_local std::vector<std::string> buffers;
+        return buffers;
+    }
+
+    void SizeEstimate::Record(size_t size)
+    {
+        const size_t estimate = _estimate.load(std::memory_order_relaxed);
+        const size_t next = (estimate == 0) ? size
+                                            : (size > estimate) ? estimate + (size - estimate) / 8
+                                                                : estimate - (estimate - size) / 8;
+        _estimate.store(next, std::memory_order_relaxed);
+    }
+
+    RenderBuffer::RenderBuffer(size_t expected)
+    {
+        std::vector<std::string> &buffers = pool();
+        if (!buffers.empty())
+        {
+            _data = std::move(buffers.back());
+            buffers.pop_back();
+            _data.clear();
+        }
+        if (expected > _data.capacity())
+            _data.reserve(expected);
+    }
+
+    // kept in order of capacity; once the pool is full the smallest is the one let go
+    RenderBuffer::~RenderBuffer()
+    {
+        if (_data.capacity() > MaxRetained)
+            return;
+        std::vector<std::string> &buffers = pool();
+        if (buffers.capacity() == 0)
+            buffers.reserve(PoolSize + 1);
+
+        auto it = buffers.begin();
+        while (it != buffers.end() && it->capacity() < _data.capacity())
+            ++it;
+        buffers.insert(it, std::move(_data));
+        if (buffers.size() > PoolSize)
+            buffers.erase(buffers.begin());
+    }
+}
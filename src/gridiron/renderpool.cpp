@@ -0,0 +1,217 @@
+/****************************************************************************************
+ * (C) Copyright 2009-2024
+ *    Jessica Mulein <jessica@digitaldefiance.org>
+ *    Digital Defiance and Contributors <https://digitaldefiance.org>
+ *
+ * Others will be credited if more developers join.
+ *
+ * License
+ *
+ * This code is licensed under the Apache license.
+ * Please see COPYING in the root of this package for details.
+ *
+ * The following libraries are only linked in, and no code is based directly from them:
+ * htmlcxx is under the Apache 2.0 License
+ ***************************************************************************************
+ * RenderPool Class
+ * ----------------
+ *
+ * Fork/join worker pool for parallel rendering. See renderpool.hpp.
+ ***************************************************************************************/
+
+#include <gridiron/renderpool.hpp>
+
+namespace GridIron
+{
+    RenderPool &RenderPool::Instance()
+    {
+        static RenderPool pool([]
+                               {
+                                   const size_t cores = std::thread::hardware_concurrency();
+                                   return (cores > 1) ? cores - 1 : 1;
+                               }());
+        return pool;
+    }
+
+    RenderPool::RenderPool(size_t threads)
+    {
+        _workers.reserve(threads);
+        for (size_t i = 0; i < threads; ++i)
+            _workers.emplace_back(&RenderPool::run, this);
+    }
+
+    RenderPool::~RenderPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_lock);
+            _stopping = true;
+        }
+        _wake.notify_all();
+        for (std::thread &worker : _workers)
+            worker.join();
+    }
+
+    void RenderPool::ForEach(size_t count, const std::function<void(size_t)> &task)
+    {
+        if (count == 0)
+            return;
+
+        auto job = std::make_shared<batch>();
+        job->task = &task;
+        job->count = count;
+        job->pending.store(count, std::memory_order_relaxed);
+
+        // nothing to gain from waking anybody for a single index
+        if (count > 1 && !_workers.empty())
+        {
+            {
+                std::lock_guard<std::mutex> lock(_lock);
+                _queue.push_back(job);
+            }
+            if (count - 1 >= _workers.size())
+                _wake.notify_all();
+            else
+                for (size_t i = 0; i < count - 1; ++i)
+                    _wake.notify_one();
+        }
+
+        work(*job);
+
+        // every index is handed out, don't leave the batch for a worker to find
+        if (count > 1 && !_workers.empty())
+        {
+            std::lock_guard<std::mutex> lock(_lock);
+            for (auto it = _queue.begin(); it != _queue.end(); ++it)
+            {
+                if (*it == job)
+                {
+                    _queue.erase(it);
+                    break;
+                }
+            }
+        }
+
+        wait(*job, true);
+    }
+
+    RenderPool::Started RenderPool::Start(size_t count, std::function<void(size_t)> task)
+    {
+        Started started;
+        if (count == 0)
+            return started;
+
+        started._job = std::make_shared<batch>();
+        batch &job = *started._job;
+        job.owned = std::move(task);
+        job.task = &job.owned;
+        job.count = count;
+        job.pending.store(count, std::memory_order_relaxed);
+
+        if (_workers.empty())
+        {
+            work(job);
+            return started;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(_lock);
+            _queue.push_back(started._job);
+        }
+        if (count >= _workers.size())
+            _wake.notify_all();
+        else
+            for (size_t i = 0; i < count; ++i)
+                _wake.notify_one();
+        return started;
+    }
+
+    void RenderPool::wait(batch &job, bool rethrow)
+    {
+        std::unique_lock<std::mutex> lock(job.lock);
+        job.done.wait(lock, [&job]
+                      { return job.pending.load(std::memory_order_acquire) == 0; });
+        if (rethrow && job.error)
+        {
+            // only the first wait rethrows it
+            std::exception_ptr error = job.error;
+            job.error = nullptr;
+            std::rethrow_exception(error);
+        }
+    }
+
+    RenderPool::Started &RenderPool::Started::operator=(Started &&other)
+    {
+        if (this != &other)
+        {
+            if (_job != nullptr)
+                wait(*_job, false);
+            _job = std::move(other._job);
+        }
+        return *this;
+    }
+
+    RenderPool::Started::~Started()
+    {
+        if (_job != nullptr)
+            wait(*_job, false);
+    }
+
+    void RenderPool::Started::Wait()
+    {
+        if (_job != nullptr)
+            wait(*_job, true);
+    }
+
+    void RenderPool::work(batch &job)
+    {
+        for (size_t i = job.next.fetch_add(1, std::memory_order_relaxed); i < job.count;
+             i = job.next.fetch_add(1, std::memory_order_relaxed))
+        {
+            try
+            {
+                (*job.task)(i);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(job.lock);
+                if (!job.error)
+                    job.error = std::current_exception();
+            }
+            finished(job);
+        }
+    }
+
+    void RenderPool::finished(batch &job)
+    {
+        if (job.pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            // take the lock so the caller can't miss the wake up between its check and its wait
+            std::lock_guard<std::mutex> lock(job.lock);
+            job.done.notify_all();
+        }
+    }
+
+    void RenderPool::run()
+    {
+        for (;;)
+        {
+            std::shared_ptr<batch> job;
+            {
+                std::unique_lock<std::mutex> lock(_lock);
+                _wake.wait(lock, [this]
+                           { return _stopping || !_queue.empty(); });
+                if (_queue.empty())
+                    return; // stopping, and nothing left
+
+                // a batch that has handed out all its indices doesn't need anyone else
+                job = _queue.front();
+                if (job->next.load(std::memory_order_relaxed) >= job->count)
+                {
+                    _queue.pop_front();
+                    continue;
+                }
+            }
+            work(*job);
+        }
+    }
+}
@@ -1,71 +1,112 @@
 #include <gridiron/tag.hpp>
 #include <gridiron/gridiron.hpp>
+#include <gridiron/renderbuffer.hpp>
 
 namespace GridIron
 {
 
-  Tag::Tag(std::string tag) : _tagName(tag) {}
+  Tag::Tag(std::string_view tag, std::pmr::memory_resource *upstream) : Tag(tag, std::string_view(), upstream) {}
 
-  Tag::Tag(std::string tag, std::string contents) : _tagName(tag), _contents(contents) {}
+  Tag::Tag(std::string_view tag, std::string_view contents, std::pmr::memory_resource *upstream)
+      : _resource(_inline, sizeof(_inline), upstream), _tagName(tag, &_resource), _contents(contents, &_resource),
+        _attributes(&_resource) {}
 
-  Tag::Tag(std::string tag, std::string contents, std::map<const char *, const char *> attributes)
-      : _tagName(tag), _contents(contents), _attributes(attributes) {}
+  Tag::Tag(std::string_view tag, std::string_view contents, attribute_init attributes, std::pmr::memory_resource *upstream)
+      : Tag(tag, contents, upstream)
+  {
+    _attributes.reserve(attributes.size());
+    for (const auto &attribute : attributes)
+      setAttribute(attribute.first, attribute.second);
+  }
 
-  Tag::Tag(std::string tag, std::map<const char *, const char *> attributes)
-      : _tagName(tag), _attributes(attributes) {}
+  Tag::Tag(std::string_view tag, attribute_init attributes, std::pmr::memory_resource *upstream)
+      : Tag(tag, std::string_view(), attributes, upstream) {}
 
-  void Tag::setAttribute(const char *attribute, const char *value)
+  // a few attributes at most, a linear scan beats any lookup structure
+  Tag::Attribute *Tag::find(std::string_view key)
   {
-    _attributes[attribute] = value;
+    for (Attribute &attribute : _attributes)
+    {
+      if (attribute.name == key)
+        return &attribute;
+    }
+    return nullptr;
   }
 
-  void Tag::setAttribute(std::string attribute, std::string value)
+  void Tag::setAttribute(std::string_view attribute, std::string_view value)
   {
-    setAttribute(attribute.c_str(), value.c_str());
+    if (Attribute *existing = find(attribute))
+    {
+      existing->value.assign(value.data(), value.size());
+      existing->hasValue = true;
+      return;
+    }
+    _attributes.push_back(Attribute{std::pmr::string(attribute, &_resource), std::pmr::string(value, &_resource), true});
   }
 
-  std::string Tag::tagName()
+  void Tag::setAttribute(std::string_view attribute)
   {
-    return _tagName;
+    if (Attribute *existing = find(attribute))
+    {
+      existing->value.clear();
+      existing->hasValue = false;
+      return;
+    }
+    _attributes.push_back(Attribute{std::pmr::string(attribute, &_resource), std::pmr::string(&_resource), false});
   }
 
-  std::map<const char *, const char *> Tag::attributes()
+  std::string_view Tag::attribute(std::string_view key, std::string_view defaultValue) const
   {
-    return _attributes;
+    for (const Attribute &attribute : _attributes)
+    {
+      if (attribute.name == key)
+        return attribute.value;
+    }
+    return defaultValue;
   }
 
-  const char *Tag::attribute(const char *key, const char *defaultValue)
+  size_t Tag::renderedLength() const
   {
-    auto it = _attributes.find(key);
-    if (it != _attributes.end())
+    size_t length = 1 + _tagName.size() + 1; // < >
+    for (const Attribute &attribute : _attributes)
     {
-      return it->second;
+      length += 1 + attribute.name.size(); // space before it
+      if (attribute.hasValue)
+        length += 3 + xmlEncodedLength(attribute.value); // ="..."
     }
-    return defaultValue;
+    if (_attributes.empty())
+      length += 2; // " /"
+    return length;
   }
 
-  std::ostream &operator<<(std::ostream &os, Tag &tag)
+  std::string &Tag::render(std::string &data) const
   {
-    os << '<' << tag.tagName();
-    bool empty = true;
-    auto attrs = tag.attributes();
-    for (const auto &it : attrs)
+    data.reserve(data.size() + renderedLength());
+    data.push_back('<');
+    data.append(_tagName);
+    for (const Attribute &attribute : _attributes)
     {
-      os << " " << it.first;
-      if (it.second != nullptr)
+      data.push_back(' ');
+      data.append(attribute.name);
+      if (attribute.hasValue)
       {
-        os << "=\"";
-        std::string attrValue = std::string(it.second);
-        os << xmlEncode(attrValue, os).rdbuf();
-        os << '\"';
+        data.append("=\"");
+        xmlEncode(attribute.value, data);
+        data.push_back('\"');
       }
-      empty = false;
     }
-    if (empty)
+    if (_attributes.empty())
     {
-      os << " /";
+      data.append(" /");
     }
-    os << '>';
-    return os;
+    data.push_back('>');
+    return data;
+  }
+
+  std::ostream &operator<<(std::ostream &os, const Tag &tag)
+  {
+    RenderBuffer data(tag.renderedLength());
+    tag.render(data.String());
+    return os.write(data.String().data(), static_cast<std::streamsize>(data.Size()));
   }
 }
@@ -0,0 +1,506 @@
+/****************************************************************************************
+ * (C) Copyright 2009-2024
+ *    Jessica Mulein <jessica@digitaldefiance.org>
+ *    Digital Defiance and Contributors <https://digitaldefiance.org>
+ *
+ * Others will be credited if more developers join.
+ *
+ * License
+ *
+ * This code is licensed under the Apache license.
+ * Please see COPYING in the root of this package for details.
+ *
+ * The following libraries are only linked in, and no code is based directly from them:
+ * htmlcxx is under the Apache 2.0 License
+ ***************************************************************************************
+ * Template / TemplateCache Classes
+ * --------------------------------
+ *
+ * Loads, parses and compiles front pages once, shares the result between requests.
+ * Optionally watches the files and swaps in a recompiled template when one changes.
+ ***************************************************************************************/
+
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <set>
+#include <gridiron/template.hpp>
+#include <gridiron/tokenizer.hpp>
+#include <gridiron/controls/page.hpp>
+#include <gridiron/exceptions.hpp>
+#include <gridiron/log.hpp>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define GRIDIRON_TEMPLATE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#define GRIDIRON_TEMPLATE_INOTIFY 1
+#include <poll.h>
+#include <sys/inotify.h>
+#endif
+
+namespace GridIron
+{
+    // tag types the template compiler handles itself rather than binding to a control
+    static constexpr std::string_view PageTagType = "Page";
+    static constexpr std::string_view ValueTagType = "Value";
+    static constexpr std::string_view FlushTagType = "Flush";
+
+    size_t Template::ValueSlot(const std::string &name) const
+    {
+        auto it = _valueSlots.find(name);
+        return (it == _valueSlots.end()) ? npos : it->second;
+    }
+
+    Template::Template(std::string path, std::string data)
+        : _path(std::move(path)), _source(std::move(data)), _data(_source)
+    {
+        if (_data.empty())
+            throw GridException(103, "front-end file is empty");
+
+        // one scan over _data, which never changes after this point. Only our tags come out of the tokenizer,
+        // everything between them is static and is emitted as one literal covering [cursor, tag offset).
+        HtmlTokenizer tokenizer(_data, HtmlNamespace);
+        size_t cursor = 0;
+        compile(tokenizer, cursor);
+        emitLiteral(cursor, _data.size());
+
+        _plan = render_plan(_ops.data(), _ops.size());
+        _controls = ConstArray<PrecompiledControl>(_elements.data(), _elements.size());
+        _controlTags = ConstArray<ControlTag>(_tags.data(), _tags.size());
+    }
+
+    Template::Template(const PrecompiledTemplate &compiled)
+        : _path(compiled.path), _data(compiled.data), _plan(compiled.plan, compiled.planSize),
+          _controls(compiled.controls, compiled.controlCount), _controlTags(compiled.tags, compiled.controlCount)
+    {
+        if (_data.empty())
+            throw GridException(103, "front-end file is empty");
+
+        // the html, the plan and the control index are the generated constants, which live as long as the program
+        for (size_t slot = 0; slot < compiled.controlCount; ++slot)
+        {
+            _nodes.emplace_back();
+            _fragments.emplace_back();
+        }
+
+        for (size_t slot = 0; slot < compiled.valueCount; ++slot)
+        {
+            _valueKeys.emplace_back(compiled.valueKeys[slot]);
+            _valueSlots.emplace(_valueKeys.back(), slot);
+        }
+    }
+
+    // controls get their tag as an htmlnode in fromHtmlNode, made from where the element is
+    static void buildNode(std::string_view data, const PrecompiledControl &element, htmlnode &node)
+    {
+        node.isTag(true);
+        node.isComment(false);
+        node.tagName(std::string(element.tagName));
+        node.offset(static_cast<unsigned int>(element.offset));
+        node.length(static_cast<unsigned int>(element.length));
+        node.text(std::string(data.substr(element.offset, element.textLength)));
+        node.closingText(std::string(data.substr(element.offset + element.length - element.closingLength, element.closingLength)));
+        node.parseAttributes();
+    }
+
+    // only made for the slots a page actually binds
+    const htmlnode &Template::ControlNode(size_t slot) const
+    {
+        nodeSlot &node = _nodes[slot];
+        std::call_once(node.built, buildNode, _data, _controls[slot], node.node);
+        return node.node;
+    }
+
+    const StaticFragments &Template::Fragments(size_t slot, fragment_builder build) const
+    {
+        fragmentSlot &fragment = _fragments[slot];
+        std::call_once(fragment.built, build, *this, slot, fragment.fragments);
+        return fragment.fragments;
+    }
+
+    std::string_view ControlTag::Attribute(std::string_view name) const
+    {
+        for (size_t i = 0; i < attributeCount; ++i)
+        {
+            if (attributes[i].first == name)
+                return attributes[i].second;
+        }
+        return std::string_view();
+    }
+
+    // record everything binding needs to know about a control tag, so pages only ever look at this index.
+    // It points straight into _data.
+    size_t Template::indexControl(std::string_view tagName, size_t offset, size_t length, size_t textLength, size_t closingLength)
+    {
+        const size_t slot = _elements.size();
+        _elements.push_back(PrecompiledControl{tagName, offset, length, textLength, closingLength});
+        _nodes.emplace_back();
+        _fragments.emplace_back();
+
+        std::vector<tag_attribute> &attributes = _attributes.emplace_back();
+        HtmlTokenizer::ParseAttributes(_data.substr(offset, textLength), attributes);
+
+        ControlTag tag{};
+        tag.type = getGridIronCustomControlName(tagName);
+        tag.attributes = attributes.data();
+        tag.attributeCount = attributes.size();
+        tag.id = tag.Attribute("id");
+        tag.autonomous = (tag.Attribute("auto") == "true");
+        _tags.push_back(tag);
+        return slot;
+    }
+
+    // the element each control tag opens: opening offset -> just past its matching closing tag, and that tag's length.
+    // same named tags nest. One pass with a stack per name, so a tag that is never closed costs nothing extra
+    // and is just itself (it has no entry).
+    static std::unordered_map<size_t, std::pair<size_t, size_t>> matchElements(HtmlTokenizer tokenizer)
+    {
+        std::unordered_map<size_t, std::pair<size_t, size_t>> elements;
+        std::unordered_map<std::string_view, std::vector<size_t>> open;
+        HtmlToken token;
+        while (tokenizer.Next(token))
+        {
+            if (token.type == HtmlTokenType::Open)
+                open[token.name].push_back(token.offset);
+            else if (token.type == HtmlTokenType::Close)
+            {
+                auto it = open.find(token.name);
+                if (it == open.end() || it->second.empty())
+                    continue; // stray
+                elements.emplace(it->second.back(), std::make_pair(token.offset + token.text.size(), token.text.size()));
+                it->second.pop_back();
+            }
+        }
+        return elements;
+    }
+
+    // turn our tags into render ops, leaving the cursor just past the last thing consumed
+    void Template::compile(HtmlTokenizer &tokenizer, size_t &cursor)
+    {
+        const auto elements = matchElements(tokenizer);
+        HtmlToken token;
+        while (tokenizer.Next(token))
+        {
+            // children of a control were consumed with it
+            if (token.type == HtmlTokenType::Literal || token.offset < cursor)
+                continue;
+
+            const std::string_view tagType = token.tagType;
+            const size_t offset = token.offset;
+
+            if (tagType == PageTagType)
+            {
+                // <GridIron::Page ...> becomes <html ...>, keeping the attributes. Its children are the document.
+                emitLiteral(cursor, offset);
+                if (token.type == HtmlTokenType::Close)
+                    _rewritten.push_back("</html>");
+                else
+                    _rewritten.push_back("<html" + std::string(token.text.substr(1 + token.name.size())));
+                emitLiteral(_rewritten.back());
+                cursor = offset + token.text.size();
+            }
+            else if (tagType == ValueTagType)
+            {
+                // <GridIron::Value key="name" /> is replaced by the registered variable; only the tag itself is consumed
+                // every use of the same name shares one slot. A closing tag, if someone wrote one, is dropped.
+                emitLiteral(cursor, offset);
+                if (token.type != HtmlTokenType::Close)
+                {
+                    const std::string key(token.Attribute("key"));
+                    auto interned = _valueSlots.emplace(key, _valueKeys.size());
+                    if (interned.second)
+                        _valueKeys.push_back(key);
+                    _ops.push_back(RenderOp{RenderOpType::Value, std::string_view(), interned.first->second});
+                }
+                cursor = offset + token.text.size();
+            }
+            else if (tagType == FlushTagType)
+            {
+                // <GridIron::Flush /> outputs nothing, it marks where what came before can be sent on its way
+                emitLiteral(cursor, offset);
+                if (token.type != HtmlTokenType::Close)
+                    _ops.push_back(RenderOp{RenderOpType::Flush, std::string_view(), 0});
+                cursor = offset + token.text.size();
+            }
+            else if (token.type != HtmlTokenType::Close)
+            {
+                // any other control renders its whole element, children included
+                size_t end = offset + token.text.size();
+                size_t closingLength = 0;
+                auto element = (token.type == HtmlTokenType::Open) ? elements.find(offset) : elements.end();
+                if (element != elements.end())
+                {
+                    end = element->second.first;
+                    closingLength = element->second.second;
+                }
+                emitLiteral(cursor, offset);
+                const size_t slot = indexControl(token.name, offset, end - offset, token.text.size(), closingLength);
+                _ops.push_back(RenderOp{RenderOpType::Control, std::string_view(), slot});
+                cursor = end;
+            }
+            // a stray closing tag stays in the output as written
+        }
+    }
+
+    void Template::emitLiteral(size_t from, size_t to)
+    {
+        if (to > from)
+            emitLiteral(_data.substr(from, to - from));
+    }
+
+    // append a literal, merging it into the previous one if they are contiguous in memory
+    void Template::emitLiteral(std::string_view text)
+    {
+        if (text.empty())
+            return;
+        if (!_ops.empty() && _ops.back().type == RenderOpType::Literal &&
+            _ops.back().text.data() + _ops.back().text.size() == text.data())
+        {
+            _ops.back().text = std::string_view(_ops.back().text.data(), _ops.back().text.size() + text.size());
+            return;
+        }
+        _ops.push_back(RenderOp{RenderOpType::Literal, text, 0});
+    }
+
+    std::shared_ptr<const Template> Template::FromFile(const std::string &fullPath)
+    {
+#ifdef GRIDIRON_TEMPLATE_MMAP
+        const int fd = ::open(fullPath.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            throw GridException(101, std::string("unable to open front-end page: ").append(fullPath).c_str());
+
+        struct stat info;
+        if (::fstat(fd, &info) != 0)
+        {
+            ::close(fd);
+            throw GridException(104, "unable to read front-end page");
+        }
+        if (info.st_size <= 0)
+        {
+            ::close(fd);
+            throw GridException(103, "front-end file is empty");
+        }
+
+        const size_t filesize = static_cast<size_t>(info.st_size);
+        void *mapped = ::mmap(nullptr, filesize, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED)
+            throw GridException(104, "unable to read front-end page");
+
+        // one copy out of the page cache, then the mapping goes. Keeping it would let an in-place rewrite
+        // of the file change (or truncate) the text under pages that are still rendering it.
+        ::posix_madvise(mapped, filesize, POSIX_MADV_SEQUENTIAL);
+        std::string buffer(static_cast<const char *>(mapped), filesize);
+        ::munmap(mapped, filesize);
+#else
+        std::ifstream file(fullPath, std::ios_base::in | std::ios_base::binary);
+        if (!file.is_open())
+            throw GridException(101, std::string("unable to open front-end page: ").append(fullPath).c_str());
+
+        // get length
+        file.seekg(0, std::ios_base::end);
+        const std::streamoff filesize = file.tellg();
+        file.seekg(0, std::ios_base::beg);
+
+        if (filesize <= 0)
+            throw GridException(103, "front-end file is empty");
+
+        // read it in one go, straight into the string we keep
+        std::string buffer(static_cast<size_t>(filesize), '\0');
+        file.read(buffer.data(), filesize);
+        if (file.gcount() != filesize)
+            throw GridException(104, "unable to read front-end page");
+#endif
+
+        return std::make_shared<const Template>(fullPath, std::move(buffer));
+    }
+
+    TemplateCache &TemplateCache::Instance()
+    {
+        static TemplateCache instance;
+        return instance;
+    }
+
+    TemplateCache::TemplateCache()
+    {
+        // the watcher thread logs, so make sure the logger is constructed first and destroyed after us
+        Logger::Instance();
+    }
+
+    TemplateCache::~TemplateCache()
+    {
+        Unwatch();
+    }
+
+    std::shared_ptr<const Template> TemplateCache::Get(const std::string &frontPage)
+    {
+        const std::string fullPath = Page::PathToPage(frontPage);
+
+        // fast path: already loaded, readers don't block each other
+        {
+            std::shared_lock<std::shared_mutex> read(_lock);
+            auto it = _templates.find(fullPath);
+            if (it != _templates.end())
+                return it->second;
+        }
+
+        // load outside the lock so a slow parse doesn't stall requests for other pages.
+        // if two threads race here, the first one to insert wins and the other copy is dropped.
+        std::shared_ptr<const Template> loaded = Template::FromFile(fullPath);
+
+        std::unique_lock<std::shared_mutex> write(_lock);
+        auto inserted = _templates.emplace(fullPath, std::move(loaded));
+        if (inserted.second && _watching)
+            watchDirectory(fullPath);
+        return inserted.first->second;
+    }
+
+    void TemplateCache::Preload(const std::string &frontPage, std::shared_ptr<const Template> compiled)
+    {
+        const std::string fullPath = Page::PathToPage(frontPage);
+        std::unique_lock<std::shared_mutex> write(_lock);
+        _templates[fullPath] = std::move(compiled);
+        if (_watching)
+            watchDirectory(fullPath);
+    }
+
+    void TemplateCache::Invalidate(const std::string &frontPage)
+    {
+        const std::string fullPath = Page::PathToPage(frontPage);
+        std::unique_lock<std::shared_mutex> write(_lock);
+        _templates.erase(fullPath);
+    }
+
+    void TemplateCache::Clear()
+    {
+        std::unique_lock<std::shared_mutex> write(_lock);
+        _templates.clear();
+    }
+
+    // how long the watcher waits for events before checking whether it should stop
+    static constexpr int WatchPollMs = 250;
+
+    bool TemplateCache::Watch()
+    {
+#ifdef GRIDIRON_TEMPLATE_INOTIFY
+        std::unique_lock<std::shared_mutex> write(_lock);
+        if (_watching)
+            return true;
+
+        _inotify = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (_inotify < 0)
+        {
+            GRIDIRON_LOG_WARN("unable to watch front-end pages: inotify_init1 failed");
+            return false;
+        }
+
+        // watch directories rather than files: editors and deploys often replace a file instead of rewriting it
+        for (const auto &entry : _templates)
+            watchDirectory(entry.first);
+
+        _watching = true;
+        _watcher = std::thread(&TemplateCache::watchLoop, this);
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    void TemplateCache::Unwatch()
+    {
+        if (!_watching.exchange(false))
+            return;
+        if (_watcher.joinable())
+            _watcher.join();
+
+#ifdef GRIDIRON_TEMPLATE_INOTIFY
+        std::unique_lock<std::shared_mutex> write(_lock);
+        ::close(_inotify); // drops all the watches with it
+        _inotify = -1;
+        _watchedDirs.clear();
+#endif
+    }
+
+    void TemplateCache::watchDirectory(const std::string &fullPath)
+    {
+#ifdef GRIDIRON_TEMPLATE_INOTIFY
+        const std::string directory = std::filesystem::path(fullPath).parent_path().string();
+        // adding the same directory again returns the same descriptor
+        const int wd = ::inotify_add_watch(_inotify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+        if (wd < 0)
+            GRIDIRON_LOG_WARN("unable to watch ", directory, " for changes");
+        else
+            _watchedDirs[wd] = directory;
+#endif
+    }
+
+    void TemplateCache::watchLoop()
+    {
+#ifdef GRIDIRON_TEMPLATE_INOTIFY
+        alignas(struct inotify_event) char buffer[4096];
+        while (_watching)
+        {
+            pollfd ready{_inotify, POLLIN, 0};
+            if (::poll(&ready, 1, WatchPollMs) <= 0)
+                continue;
+
+            const ssize_t length = ::read(_inotify, buffer, sizeof(buffer));
+            if (length <= 0)
+                continue;
+
+            // a save usually shows up as several events, only recompile each file once
+            std::set<std::string> changed;
+            {
+                std::shared_lock<std::shared_mutex> read(_lock);
+                for (const char *p = buffer; p < buffer + length;)
+                {
+                    const inotify_event *event = reinterpret_cast<const inotify_event *>(p);
+                    p += sizeof(inotify_event) + event->len;
+                    if (event->len == 0)
+                        continue;
+
+                    auto directory = _watchedDirs.find(event->wd);
+                    if (directory == _watchedDirs.end())
+                        continue;
+                    std::string fullPath = (std::filesystem::path(directory->second) / event->name).string();
+                    if (_templates.find(fullPath) != _templates.end())
+                        changed.insert(std::move(fullPath));
+                }
+            }
+
+            for (const std::string &fullPath : changed)
+                reload(fullPath);
+        }
+#endif
+    }
+
+    // compile the new version off to the side, then swap it in. On failure (a half written file, say)
+    // the old version stays in service.
+    void TemplateCache::reload(const std::string &fullPath)
+    {
+        std::shared_ptr<const Template> fresh;
+        try
+        {
+            fresh = Template::FromFile(fullPath);
+        }
+        catch (const GridException &e)
+        {
+            GRIDIRON_LOG_WARN("keeping the cached ", fullPath, ", reload failed: ", e.string());
+            return;
+        }
+
+        std::unique_lock<std::shared_mutex> write(_lock);
+        auto it = _templates.find(fullPath);
+        if (it == _templates.end()) // invalidated meanwhile, the next Get loads it
+            return;
+        it->second = std::move(fresh);
+        write.unlock();
+        GRIDIRON_LOG_INFO("reloaded ", fullPath);
+    }
+}
@@ -0,0 +1,39 @@
+/****************************************************************************************
+ * (C) Copyright 2009-2024
+ *    Jessica Mulein <jessica@digitaldefiance.org>
+ *    Digital Defiance and Contributors <https://digitaldefiance.org>
+ *
+ * Others will be credited if more developers join.
+ *
+ * License
+ *
+ * This code is licensed under the Apache license.
+ * Please see COPYING in the root of this package for details.
+ *
+ * The following libraries are only linked in, and no code is based directly from them:
+ * htmlcxx is under the Apache 2.0 License
+ ***************************************************************************************
+ * Static initializer preload, for StaticPreloadTest
+ * -------------------------------------------------
+ *
+ * Compiles and preloads a template while the test executable's globals are being set up,
+ * before the library's own, the way an application preloading from a static might.
+ * Kept out of tests.cpp so it is a separate translation unit.
+ ***************************************************************************************/
+
+#include <gridiron/template.hpp>
+#include <memory>
+#include <string>
+
+namespace GridIron::test
+{
+    extern const char *const StaticPreloadPage = "::static-preload::";
+
+    static const bool preloaded = []
+    {
+        TemplateCache::Instance().Preload(StaticPreloadPage, std::make_shared<const Template>(
+            "::static-preload::",
+            "<GridIron::Page><GridIron::Label auto=\"true\" id=\"lblStatic\">static</GridIron::Label></GridIron::Page>"));
+        return true;
+    }();
+}
@@ -6,7 +6,32 @@
 
 #include "oatpp-swagger/oas3/Model.hpp"
 
+#include <gridiron/gridiron.hpp>
+#include <gridiron/arena.hpp>
+#include <gridiron/formdata.hpp>
+#include <gridiron/outputcache.hpp>
+#include <gridiron/renderbuffer.hpp>
+#include <gridiron/renderpool.hpp>
+#include <gridiron/tag.hpp>
+#include <gridiron/viewstate.hpp>
+#include <gridiron/tokenizer.hpp>
+#include <gridiron/controls/page.hpp>
+#include <gridiron/controls/ui/button.hpp>
+#include <gridiron/controls/ui/label.hpp>
+#include <gridiron/controls/ui/textbox.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace GridIron::test {
+    extern const char *const StaticPreloadPage; // preloaded from a static initializer, see preload.cpp
+}
 
 namespace {
 
@@ -19,11 +44,824 @@ namespace {
         }
     };
 
+    class XmlEncodeTest : public oatpp::test::UnitTest {
+    public:
+        XmlEncodeTest() : oatpp::test::UnitTest("XmlEncode") {}
+
+        void onRun() override {
+            OATPP_ASSERT(GridIron::xmlEncode("") == "");
+            OATPP_ASSERT(GridIron::xmlEncode("plain text") == "plain text");
+            OATPP_ASSERT(GridIron::xmlEncode("<a href=\"x\">Tom & Jerry's</a>") ==
+                         "&lt;a href=&quot;x&quot;&gt;Tom &amp; Jerry&apos;s&lt;/a&gt;");
+
+            // long enough to go through the vector code paths, escapes straddling block boundaries
+            std::string input, expected;
+            for (int i = 0; i < 100; ++i) {
+                input += "0123456789abcd<&";
+                expected += "0123456789abcd&lt;&amp;";
+            }
+            OATPP_ASSERT(GridIron::xmlEncodedLength(input) == expected.size());
+            OATPP_ASSERT(GridIron::xmlEncode(input) == expected);
+
+            // appends, doesn't overwrite
+            std::string out = "prefix:";
+            GridIron::xmlEncode("a>b", out);
+            OATPP_ASSERT(out == "prefix:a&gt;b");
+
+            std::ostringstream os;
+            GridIron::xmlEncode(std::string_view("'q'"), os);
+            OATPP_ASSERT(os.str() == "&apos;q&apos;");
+
+            std::istringstream is("x\"y");
+            std::ostringstream os2;
+            GridIron::xmlEncode(os2, is);
+            OATPP_ASSERT(os2.str() == "x&quot;y");
+        }
+    };
+
+    class ParseTagTest : public oatpp::test::UnitTest {
+    public:
+        ParseTagTest() : oatpp::test::UnitTest("ParseTag") {}
+
+        void onRun() override {
+            OATPP_ASSERT(GridIron::getGridIronCustomControlName("GridIron::Label") == "Label");
+            OATPP_ASSERT(GridIron::getGridIronCustomControlName("<GridIron::Label id=\"x\">") == "Label");
+            OATPP_ASSERT(GridIron::getGridIronCustomControlName("< GridIron::Value/>") == "Value");
+            OATPP_ASSERT(GridIron::getGridIronCustomControlName("div").empty());
+            OATPP_ASSERT(GridIron::getGridIronCustomControlName("Other::Label").empty());
+            OATPP_ASSERT(GridIron::getGridIronCustomControlName("GridIron::").empty());
+            OATPP_ASSERT(GridIron::getGridIronCustomControlName("GridIron::Label:x").empty());
+
+            // views into what was scanned, whatever the namespace
+            const std::string tag = "<Other::Thing2 a=\"b\">";
+            auto parsed = GridIron::gridironParseTag(tag);
+            OATPP_ASSERT(parsed.first == "Other" && parsed.second == "Thing2");
+            OATPP_ASSERT(parsed.first.data() == tag.data() + 1);
+        }
+    };
+
+    class TokenizerTest : public oatpp::test::UnitTest {
+    public:
+        TokenizerTest() : oatpp::test::UnitTest("Tokenizer") {}
+
+        void onRun() override {
+            // only our tags come out, comments and script contents are text
+            const std::string html = "<!-- <GridIron::Label id=\"c\"> --><script>x='<GridIron::Value/>'</script>"
+                                     "<p title='a>b'><GridIron::Label id=lbl auto=\"true\">hi</GridIron::Label><GridIron::Value key='k'/></p>";
+            GridIron::HtmlTokenizer tokenizer(html, "GridIron");
+            GridIron::HtmlToken token;
+            std::vector<GridIron::HtmlTokenType> types;
+            while (tokenizer.Next(token)) {
+                types.push_back(token.type);
+                if (token.type == GridIron::HtmlTokenType::Open) {
+                    OATPP_ASSERT(token.tagType == "Label");
+                    OATPP_ASSERT(token.Attribute("id") == "lbl" && token.Attribute("auto") == "true");
+                } else if (token.type == GridIron::HtmlTokenType::SelfClosing) {
+                    OATPP_ASSERT(token.tagType == "Value" && token.Attribute("key") == "k");
+                }
+            }
+            OATPP_ASSERT((types == std::vector<GridIron::HtmlTokenType>{
+                GridIron::HtmlTokenType::Literal, GridIron::HtmlTokenType::Open, GridIron::HtmlTokenType::Literal,
+                GridIron::HtmlTokenType::Close, GridIron::HtmlTokenType::SelfClosing, GridIron::HtmlTokenType::Literal}));
+
+            // an unclosed control tag is just itself, the one after it still gets its children
+            GridIron::Template unclosed("::unclosed::",
+                "<p><GridIron::Label id=a>x<GridIron::Label id=b>y</GridIron::Label></p><GridIron::Label id=c>");
+            OATPP_ASSERT(unclosed.ControlCount() == 3);
+            OATPP_ASSERT(unclosed.ControlNode(0).length() == std::string("<GridIron::Label id=a>").size());
+            OATPP_ASSERT(unclosed.ControlNode(1).length() == std::string("<GridIron::Label id=b>y</GridIron::Label>").size());
+            OATPP_ASSERT(unclosed.ControlNode(2).closingText().empty());
+        }
+    };
+
+    class OutputCacheTest : public oatpp::test::UnitTest {
+    public:
+        OutputCacheTest() : oatpp::test::UnitTest("OutputCache") {}
+
+        void onRun() override {
+            GridIron::OutputCache &cache = GridIron::OutputCache::Instance();
+            cache.Clear();
+
+            cache.Put("a", std::make_shared<const std::string>("cached"), std::chrono::minutes(1));
+            OATPP_ASSERT(cache.Get("a") != nullptr && *cache.Get("a") == "cached");
+            cache.Put("b", std::make_shared<const std::string>("gone"), std::chrono::milliseconds(1));
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            OATPP_ASSERT(cache.Get("b") == nullptr);
+
+            // a fragment is reused until it expires, whatever the control holds now
+            auto html = std::make_shared<const GridIron::Template>("::test::",
+                "<GridIron::Page><GridIron::Label id=\"lbl\">x</GridIron::Label></GridIron::Page>");
+            std::string first, second, third;
+            {
+                GridIron::Page page("cached", html);
+                auto lbl = page.Create<GridIron::controls::Label>("lbl", "first");
+                lbl->SetOutputCache({std::chrono::minutes(1), {}, {"lang"}});
+                page.SetQueryParameter("lang", "en");
+                page.render(first);
+            }
+            {
+                GridIron::Page page("cached", html);
+                auto lbl = page.Create<GridIron::controls::Label>("lbl", "second");
+                lbl->SetOutputCache({std::chrono::minutes(1), {}, {"lang"}});
+                page.SetQueryParameter("lang", "en");
+                page.render(second);
+                page.SetQueryParameter("lang", "fr");
+                page.render(third);
+            }
+            OATPP_ASSERT(first == second);
+            OATPP_ASSERT(second != third && third.find("second") != std::string::npos);
+
+            // a postback render neither reads the cache nor writes it, for the page or its controls
+            auto posted = std::make_shared<const GridIron::Template>("::posted::",
+                "<GridIron::Page><GridIron::Label id=\"lbl\">x</GridIron::Label></GridIron::Page>");
+            auto renderPage = [&posted](const std::string &text, bool postBack)
+            {
+                GridIron::Page page("posted", posted);
+                page.SetOutputCache({std::chrono::minutes(1), {}, {}});
+                page.Create<GridIron::controls::Label>("lbl", text)->SetOutputCache({std::chrono::minutes(1), {}, {}});
+                if (postBack)
+                {
+                    GridIron::FormData form;
+                    form.Parse("lbl=x");
+                    page.ProcessPostBack(form);
+                }
+                std::string output;
+                page.render(output);
+                return output;
+            };
+            const std::string get = renderPage("get", false);
+            OATPP_ASSERT(renderPage("mine", true).find("mine") != std::string::npos);
+            OATPP_ASSERT(renderPage("other", false) == get);
+
+            // least recently used goes first once over budget
+            cache.SetBudget(GridIron::OutputCache::ShardCount * 1024);
+            for (int i = 0; i < 1000; ++i)
+                cache.Put("key" + std::to_string(i), std::make_shared<const std::string>(200, 'x'), std::chrono::minutes(1));
+            OATPP_ASSERT(cache.Size() <= cache.Budget());
+            OATPP_ASSERT(cache.Get("key999") != nullptr && cache.Get("key0") == nullptr);
+
+            cache.SetBudget(GridIron::OutputCache::DefaultBudget);
+            cache.Clear();
+        }
+    };
+
+    class TagTest : public oatpp::test::UnitTest {
+    public:
+        TagTest() : oatpp::test::UnitTest("Tag") {}
+
+        void onRun() override {
+            // insertion order, replaced values keep their place, appends to what's there
+            GridIron::Tag tag("div", {{"id", "x"}, {"class", "a&b"}});
+            tag.setAttribute("id", "y");
+            tag.setAttribute("disabled");
+            std::string data = ">";
+            tag.render(data);
+            OATPP_ASSERT(data == "><div id=\"y\" class=\"a&amp;b\" disabled>");
+            OATPP_ASSERT(data.size() == 1 + tag.renderedLength());
+            OATPP_ASSERT(tag.attribute("class") == "a&b" && tag.attribute("missing", "default") == "default");
+
+            std::ostringstream os;
+            os << GridIron::Tag("br");
+            OATPP_ASSERT(os.str() == "<br />");
+        }
+    };
+
+    class RefreshTest : public oatpp::test::UnitTest {
+    public:
+        RefreshTest() : oatpp::test::UnitTest("Refresh") {}
+
+        void onRun() override {
+            auto html = std::make_shared<const GridIron::Template>("::test::",
+                "<GridIron::Page><GridIron::Label auto=\"true\" id=\"a\">one</GridIron::Label>"
+                "[<GridIron::Value key=\"a.Text\" />]<GridIron::Label id=\"b\">two</GridIron::Label>"
+                "[<GridIron::Value key=\"a.Text\" />]</GridIron::Page>");
+            GridIron::Page page("refresh", html);
+            auto b = page.Create<GridIron::controls::Label>("b");
+            auto a = dynamic_cast<GridIron::controls::Label *>(page.FindByID("a"));
+            OATPP_ASSERT(a != nullptr);
+
+            std::string first = page.Refresh();
+            std::string full;
+            page.render(full);
+            OATPP_ASSERT(first == full);
+
+            // shorter, longer and same length replacements all land where a full render puts them
+            a->SetText("a much longer text");
+            b->SetText("2");
+            std::string expected;
+            page.render(expected);
+            OATPP_ASSERT(page.Refresh() == expected);
+
+            b->SetText("3");
+            expected.clear();
+            page.render(expected);
+            OATPP_ASSERT(page.Refresh() == expected);
+            OATPP_ASSERT(page.Refresh() == expected); // nothing dirty
+
+            // controls on one page changed from different threads, as async data comes in
+            std::thread setA([a] { for (int i = 0; i <= 1000; ++i) a->SetText("a" + std::to_string(i)); });
+            std::thread setB([b] { for (int i = 0; i <= 1000; ++i) b->SetText("b" + std::to_string(i)); });
+            setA.join();
+            setB.join();
+            expected.clear();
+            page.render(expected);
+            OATPP_ASSERT(page.Refresh() == expected && expected.find(">a1000<") != std::string::npos);
+        }
+    };
+
+    class ViewStateTest : public oatpp::test::UnitTest {
+    public:
+        ViewStateTest() : oatpp::test::UnitTest("ViewState") {}
+
+        void onRun() override {
+            GridIron::ViewStateWriter writer;
+            writer.BeginControl("lbl");
+            writer.Write("Text", "hello & <bye>");
+            writer.Write("Height", static_cast<int64_t>(-42));
+            writer.BeginControl("empty"); // nothing written, left out
+            writer.BeginControl("big");
+            writer.Write("Text", std::string(4096, 'x'));
+            const std::string token = writer.Finish("secret");
+
+            GridIron::ViewState state;
+            OATPP_ASSERT(state.Parse(token, "secret"));
+            OATPP_ASSERT(state.Controls().size() == 2 && state.Find("empty") == nullptr);
+            int64_t height = 0;
+            OATPP_ASSERT(state.Find("lbl")->Get("Text") == "hello & <bye>");
+            OATPP_ASSERT(state.Find("lbl")->GetInt("Height", height) && height == -42);
+            OATPP_ASSERT(state.Find("big")->Get("Text").size() == 4096);
+
+            // wrong key, tampering and garbage are all refused
+            OATPP_ASSERT(!state.Parse(token, "other") && state.Controls().empty());
+            std::string tampered = token;
+            tampered[tampered.size() / 2] = (tampered[tampered.size() / 2] == 'A') ? 'B' : 'A';
+            OATPP_ASSERT(!state.Parse(tampered, "secret"));
+            OATPP_ASSERT(!state.Parse("not base64!", "secret"));
+
+            // a token is only good for the scope it was made for
+            GridIron::ViewStateWriter scoped;
+            scoped.BeginControl("lbl");
+            scoped.Write("Text", "x");
+            const std::string scopedToken = scoped.Finish("secret", "one.html");
+            OATPP_ASSERT(state.Parse(scopedToken, "secret", "one.html"));
+            OATPP_ASSERT(!state.Parse(scopedToken, "secret", "two.html") && !state.Parse(scopedToken, "secret"));
+
+            // controls get their state back through the page
+            auto html = std::make_shared<const GridIron::Template>("::test::",
+                "<GridIron::Page><GridIron::Label id=\"lbl\">default</GridIron::Label></GridIron::Page>");
+            std::string saved;
+            {
+                GridIron::Page page("viewstate", html);
+                auto lbl = page.Create<GridIron::controls::Label>("lbl");
+                lbl->SetViewStateEnabled(true);
+                lbl->SetText("changed");
+                lbl->SetWidth(7);
+                saved = page.SerializeViewState();
+            }
+            GridIron::Page page("viewstate", html);
+            auto lbl = page.Create<GridIron::controls::Label>("lbl");
+            lbl->SetViewStateEnabled(true);
+            OATPP_ASSERT(page.RestoreViewState(saved));
+            OATPP_ASSERT(lbl->ViewStateValid() && lbl->GetText() == "changed" && lbl->GetWidth() == 7);
+
+            // replayed on another page with the same control ids, it's refused
+            auto other = std::make_shared<const GridIron::Template>("::other::",
+                "<GridIron::Page><GridIron::Label id=\"lbl\">default</GridIron::Label></GridIron::Page>");
+            GridIron::Page otherPage("viewstate", other);
+            auto otherLbl = otherPage.Create<GridIron::controls::Label>("lbl");
+            otherLbl->SetViewStateEnabled(true);
+            OATPP_ASSERT(!otherPage.RestoreViewState(saved));
+            OATPP_ASSERT(!otherLbl->ViewStateValid());
+        }
+    };
+
+    class PostBackTest : public oatpp::test::UnitTest {
+    public:
+        PostBackTest() : oatpp::test::UnitTest("PostBack") {}
+
+        void onRun() override {
+            // fed a byte at a time, escapes and fields split anywhere
+            const std::string body = "txt=J%C3%B6rg+M&empty=&flag&&bad=%zz%4&txt=second";
+            GridIron::FormData form;
+            for (char c : body)
+                OATPP_ASSERT(form.Append(std::string_view(&c, 1)));
+            OATPP_ASSERT(form.Finish());
+            OATPP_ASSERT(form.Count() == 5);
+            OATPP_ASSERT(form.Get("txt") == "J\xC3\xB6rg M"); // the first one
+            OATPP_ASSERT(form.Has("empty") && form.Get("empty").empty());
+            OATPP_ASSERT(form.Has("flag") && form.Get("bad") == "%zz%4");
+            OATPP_ASSERT(form.Field(4).first == "txt" && form.Field(4).second == "second");
+
+            GridIron::FormData whole;
+            OATPP_ASSERT(whole.Parse(body) && whole.Count() == 5 && whole.Get("txt") == form.Get("txt"));
+            GridIron::FormData small(8);
+            OATPP_ASSERT(!small.Append("a=1&b=2&c=3") && small.Overflowed());
+            std::string bare;
+            for (int i = 0; i < 999; ++i)
+                bare += "a&";
+            GridIron::FormData flags;
+            OATPP_ASSERT(flags.Parse(bare + "b=1") && flags.Count() == 1000);
+            OATPP_ASSERT(flags.Field(0).second.empty() && flags.Get("b") == "1");
+
+            // built in, whether or not anything links in its .cpp
+            OATPP_ASSERT(GridIron::ControlFactory::Instance().Find("ViewStateField") != nullptr);
+
+            // the page as sent, then posted back with the text changed and the button pressed
+            auto html = std::make_shared<const GridIron::Template>("::test::",
+                "<GridIron::Page><form><GridIron::ViewStateField auto=\"true\" id=\"vs\" />"
+                "<GridIron::TextBox id=\"txt\" value=\"default\" /><GridIron::Button id=\"btn\" value=\"Go\" /></form>"
+                "<GridIron::Label id=\"lbl\">none</GridIron::Label></GridIron::Page>");
+            std::string token;
+            {
+                GridIron::Page page("postback", html);
+                auto txt = page.Create<GridIron::controls::TextBox>("txt");
+                page.Create<GridIron::controls::Button>("btn");
+                page.Create<GridIron::controls::Label>("lbl");
+                txt->SetText("sent");
+                std::string output;
+                page.render(output);
+                OATPP_ASSERT(output.find("name=\"txt\" value=\"sent\"") != std::string::npos);
+                OATPP_ASSERT(output.find("type=\"submit\" id=\"btn\" name=\"btn\" value=\"Go\"") != std::string::npos);
+                token = page.SerializeViewState();
+                OATPP_ASSERT(!token.empty() && output.find("name=\"__VIEWSTATE\" value=\"" + token + "\"") != std::string::npos);
+            }
+
+            std::vector<std::string> events;
+            GridIron::Page page("postback", html);
+            auto txt = page.Create<GridIron::controls::TextBox>("txt");
+            auto btn = page.Create<GridIron::controls::Button>("btn");
+            auto lbl = page.Create<GridIron::controls::Label>("lbl");
+            txt->OnTextChanged([&events](GridIron::controls::TextBox &box) { events.push_back("changed:" + box.GetText()); });
+            btn->OnClick([&events, txt, lbl](GridIron::controls::Button &, std::string_view argument)
+                         {
+                             events.push_back("click:" + std::string(argument));
+                             lbl->SetText(txt->GetText());
+                         });
+
+            // the button comes first in the body, its handler still sees the posted text
+            GridIron::FormData posted;
+            OATPP_ASSERT(posted.Parse("btn=Go&__VIEWSTATE=" + token + "&txt=typed+in&unknown=1"));
+            OATPP_ASSERT(page.ProcessPostBack(posted) && page.IsPostBack());
+            OATPP_ASSERT(events.size() == 2 && events[0] == "changed:typed in" && events[1] == "click:Go");
+            OATPP_ASSERT(lbl->GetText() == "typed in" && txt->ViewStateValid());
+
+            // __EVENTTARGET can't name a control that doesn't send forms in place of the button pressed
+            events.clear();
+            GridIron::FormData retargeted;
+            OATPP_ASSERT(retargeted.Parse("btn=Go&__EVENTTARGET=lbl&__EVENTARGUMENT=x"));
+            page.ProcessPostBack(retargeted);
+            OATPP_ASSERT(events.size() == 1 && events[0] == "click:Go");
+
+            // posting back what was sent isn't a change
+            events.clear();
+            GridIron::Page again("postback", html);
+            auto same = again.Create<GridIron::controls::TextBox>("txt");
+            same->OnTextChanged([&events](GridIron::controls::TextBox &) { events.push_back("changed"); });
+            GridIron::FormData unchanged;
+            OATPP_ASSERT(unchanged.Parse("__VIEWSTATE=" + token + "&txt=sent"));
+            OATPP_ASSERT(again.ProcessPostBack(unchanged) && events.empty() && same->GetText() == "sent");
+
+            // a forged ViewState is refused, the fields are still taken
+            GridIron::FormData forged;
+            OATPP_ASSERT(forged.Parse("__VIEWSTATE=AAAA&txt=x"));
+            OATPP_ASSERT(!again.ProcessPostBack(forged) && same->GetText() == "x");
+        }
+    };
+
+    class ParallelRenderTest : public oatpp::test::UnitTest {
+    public:
+        ParallelRenderTest() : oatpp::test::UnitTest("ParallelRender") {}
+
+        // doesn't render until the test opens the gate
+        struct GatedLabel : public GridIron::controls::Label {
+            GatedLabel(std::string id, GridIron::Control *parent, std::atomic<bool> *gate)
+                : GridIron::controls::Label(std::move(id), parent), gate(gate) {}
+            void render(std::string &data) override {
+                while (!gate->load())
+                    std::this_thread::yield();
+                GridIron::controls::Label::render(data);
+            }
+            std::atomic<bool> *gate;
+        };
+
+        void onRun() override {
+            // every index exactly once, nested batches included
+            GridIron::RenderPool pool(3);
+            std::vector<std::atomic<int>> seen(200);
+            pool.ForEach(seen.size(), [&pool, &seen](size_t i)
+                         {
+                             if (i % 50 == 0)
+                                 pool.ForEach(4, [](size_t) {});
+                             seen[i].fetch_add(1);
+                         });
+            for (auto &count : seen)
+                OATPP_ASSERT(count.load() == 1);
+
+            bool thrown = false;
+            try
+            {
+                pool.ForEach(10, [](size_t i)
+                             { if (i == 7) throw std::runtime_error("boom"); });
+            }
+            catch (const std::runtime_error &)
+            {
+                thrown = true;
+            }
+            OATPP_ASSERT(thrown);
+
+            // started batches run without the caller
+            std::vector<std::atomic<int>> started(50);
+            auto batch = pool.Start(started.size(), [&started](size_t i) { started[i].fetch_add(1); });
+            batch.Wait();
+            for (auto &count : started)
+                OATPP_ASSERT(count.load() == 1);
+            thrown = false;
+            try
+            {
+                pool.Start(3, [](size_t i) { if (i == 1) throw std::runtime_error("boom"); }).Wait();
+            }
+            catch (const std::runtime_error &)
+            {
+                thrown = true;
+            }
+            OATPP_ASSERT(thrown);
+
+            // independent controls come out in document order, same as rendering them one by one
+            std::string markup = "<GridIron::Page>";
+            for (int i = 0; i < 8; ++i)
+                markup += "<p>" + std::to_string(i) + "</p><GridIron::Label id=\"lbl" + std::to_string(i) + "\">x</GridIron::Label>";
+            markup += "</GridIron::Page>";
+            auto html = std::make_shared<const GridIron::Template>("::test::", markup);
+
+            std::string serial;
+            std::string parallel;
+            for (bool independent : {false, true})
+            {
+                GridIron::Page page("parallel", html);
+                for (int i = 0; i < 8; ++i)
+                {
+                    auto label = page.Create<GridIron::controls::Label>("lbl" + std::to_string(i));
+                    label->SetText("label " + std::to_string(i));
+                    label->SetRenderIndependent(independent);
+                }
+                page.render(independent ? parallel : serial);
+                if (independent)
+                    OATPP_ASSERT(page.Refresh() == parallel);
+            }
+            OATPP_ASSERT(!serial.empty() && parallel == serial);
+
+            // streamed, they render on the pool while what comes before them goes out
+            std::atomic<bool> gate{false};
+            auto streamed = std::make_shared<GridIron::Page>("parallel", std::make_shared<const GridIron::Template>("::test::",
+                "<GridIron::Page><p>before</p><GridIron::Label id=\"gated\">x</GridIron::Label><p>after</p></GridIron::Page>"));
+            streamed->Create<GatedLabel>("gated", &gate)->SetRenderIndependent(true);
+            GridIron::PageReader reader(streamed);
+            char buffer[256];
+            std::string read(buffer, reader.Read(buffer, sizeof(buffer)));
+            OATPP_ASSERT(read == "<html><p>before</p>" && reader.Waiting());
+            gate = true;
+            while (!reader.Done())
+            {
+                reader.Wait();
+                read.append(buffer, reader.Read(buffer, sizeof(buffer)));
+            }
+            std::string whole;
+            streamed->render(whole);
+            OATPP_ASSERT(read == whole);
+        }
+    };
+
+    class AsyncRenderTest : public oatpp::test::UnitTest {
+    public:
+        AsyncRenderTest() : oatpp::test::UnitTest("AsyncRender") {}
+
+        // a label whose text comes from a lookup that finishes on another thread
+        struct FetchedLabel : public GridIron::controls::Label {
+            using Label::Label;
+            bool ReadyToRender() const override { return fetched.load(); }
+            void Fetched() { fetched = true; NotifyReady(); }
+            std::atomic<bool> fetched{false};
+        };
+
+        void onRun() override {
+            auto html = std::make_shared<const GridIron::Template>("::test::",
+                "<GridIron::Page><p>head</p><GridIron::Label id=\"lbl\">x</GridIron::Label><p>tail</p></GridIron::Page>");
+
+            // a reader sends what it can and stops in front of the label
+            auto page = std::make_shared<GridIron::Page>("async", html);
+            auto label = page->Create<FetchedLabel>("lbl");
+            label->SetText("fetched");
+            std::atomic<int> woken{0};
+            page->SetReadyListener([&woken] { woken.fetch_add(1); });
+
+            GridIron::PageReader reader(page);
+            char buffer[4096];
+            std::string output(buffer, reader.Read(buffer, sizeof(buffer)));
+            OATPP_ASSERT(output.find("head") != std::string::npos && output.find("fetched") == std::string::npos);
+            OATPP_ASSERT(reader.Waiting() && !reader.Done());
+            OATPP_ASSERT(reader.Read(buffer, sizeof(buffer)) == 0 && reader.Waiting());
+
+            std::thread([label] { label->Fetched(); }).join();
+            OATPP_ASSERT(woken.load() == 1 && page->Ready());
+            for (size_t n; (n = reader.Read(buffer, sizeof(buffer))) > 0;)
+                output.append(buffer, n);
+            OATPP_ASSERT(reader.Done() && !reader.Waiting());
+            OATPP_ASSERT(output.find("fetched") != std::string::npos && output.find("tail") != std::string::npos);
+            page->SetReadyListener(nullptr);
+
+            // render() blocks until it's in
+            GridIron::Page blocking("async", html);
+            auto late = blocking.Create<FetchedLabel>("lbl");
+            late->SetText("late");
+            std::thread fetch([late]
+                              {
+                                  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                                  late->Fetched();
+                              });
+            std::string rendered;
+            blocking.render(rendered);
+            fetch.join();
+            OATPP_ASSERT(rendered.find("late") != std::string::npos);
+        }
+    };
+
+    class FlushTest : public oatpp::test::UnitTest {
+    public:
+        FlushTest() : oatpp::test::UnitTest("Flush") {}
+
+        void onRun() override {
+            auto html = std::make_shared<const GridIron::Template>("::test::",
+                "<GridIron::Page><head>h</head><GridIron::Flush /><GridIron::Flush />"
+                "<p>body</p><GridIron::Label id=\"lbl\">x</GridIron::Label></GridIron::Page>");
+            auto page = std::make_shared<GridIron::Page>("flush", html);
+            page->Create<GridIron::controls::Label>("lbl")->SetText("text");
+
+            // the head comes out on its own, however big the buffer
+            GridIron::PageReader reader(page);
+            char buffer[4096];
+            const std::string head(buffer, reader.Read(buffer, sizeof(buffer)));
+            OATPP_ASSERT(head == "<html><head>h</head>");
+            const std::string rest(buffer, reader.Read(buffer, sizeof(buffer)));
+            OATPP_ASSERT(rest.find("<p>body</p>") == 0 && rest.find("text") != std::string::npos && reader.Done());
+
+            // and the flush points leave no trace in the output
+            std::string rendered;
+            page->render(rendered);
+            OATPP_ASSERT(rendered == head + rest && rendered.find("Flush") == std::string::npos);
+            OATPP_ASSERT(page->Refresh() == rendered);
+        }
+    };
+
+    class RenderBufferTest : public oatpp::test::UnitTest {
+    public:
+        RenderBufferTest() : oatpp::test::UnitTest("RenderBuffer") {}
+
+        void onRun() override {
+            std::string digits;
+            GridIron::appendInteger(digits, 0).push_back(' ');
+            GridIron::appendInteger(digits, -42).push_back(' ');
+            GridIron::appendInteger(digits, INT64_MIN).push_back(' ');
+            GridIron::appendInteger(digits, UINT64_MAX);
+            OATPP_ASSERT(digits == "0 -42 -9223372036854775808 18446744073709551615");
+
+            // a released buffer comes back, grown, to the next one on the thread; nested ones get their own
+            const char *first;
+            {
+                GridIron::RenderBuffer buffer(64 << 10);
+                buffer.Append("id=").Append(7).Append(';').Append(size_t(12));
+                OATPP_ASSERT(buffer.View() == "id=7;12");
+                first = buffer.String().data();
+            }
+            {
+                GridIron::RenderBuffer again;
+                OATPP_ASSERT(again.Size() == 0 && again.String().capacity() >= (64 << 10) && again.String().data() == first);
+                GridIron::RenderBuffer nested;
+                OATPP_ASSERT(nested.String().data() != again.String().data());
+            }
+
+            GridIron::SizeEstimate estimate;
+            OATPP_ASSERT(estimate.Predict() == 0);
+            estimate.Record(800);
+            OATPP_ASSERT(estimate.Predict() == 900);
+            for (int i = 0; i < 100; ++i)
+                estimate.Record(1600);
+            OATPP_ASSERT(estimate.Predict() > 1600 && estimate.Predict() <= 1800);
+
+            // rendering a page teaches its template how big it comes out
+            auto html = std::make_shared<const GridIron::Template>("::test::",
+                "<GridIron::Page><GridIron::Label id=\"lbl\">x</GridIron::Label></GridIron::Page>");
+            GridIron::Page page("estimate", html);
+            page.Create<GridIron::controls::Label>("lbl")->SetText(std::string(1000, 'y'));
+            std::string output;
+            page.render(output);
+            OATPP_ASSERT(html->OutputSize().Predict() >= output.size());
+        }
+    };
+
+    class StaticFragmentTest : public oatpp::test::UnitTest {
+    public:
+        StaticFragmentTest() : oatpp::test::UnitTest("StaticFragment") {}
+
+        void onRun() override {
+            auto html = std::make_shared<const GridIron::Template>("::test::",
+                "<GridIron::Page><GridIron::Label id=\"lbl\">a &amp; b</GridIron::Label>"
+                "<GridIron::TextBox id=\"txt\" value=\"v\" /></GridIron::Page>");
+            const std::string expected = "<html><div style=\"align: left; height: 0 px; width: 0 px; \" id=\"lbl\">a &amp;amp; b</div>"
+                                         "<input type=\"text\" id=\"txt\" name=\"txt\" value=\"v\" /></html>";
+
+            // pages from the same template share the fragments, and render just as if built by hand
+            for (int i = 0; i < 2; ++i)
+            {
+                GridIron::Page page("fragments", html);
+                auto label = page.Create<GridIron::controls::Label>("lbl");
+                auto text = page.Create<GridIron::controls::TextBox>("txt");
+                std::string output;
+                page.render(output);
+                OATPP_ASSERT(output == expected);
+                OATPP_ASSERT(label->GetText() == "a &amp; b" && text->GetText() == "v");
+            }
+            OATPP_ASSERT(&html->Fragments(0, nullptr) == &html->Fragments(0, nullptr));
+
+            // anything changed renders the long way
+            GridIron::Page page("fragments", html);
+            auto label = page.Create<GridIron::controls::Label>("lbl");
+            page.Create<GridIron::controls::TextBox>("txt");
+            std::string output;
+            page.render(output);
+            *label->GetTextPtr() = "<changed>"; // through the pointer, not SetText
+            label->SetHeight(3);
+            output.clear();
+            page.render(output);
+            OATPP_ASSERT(output.find("height: 3 px; width: 0 px; \" id=\"lbl\">&lt;changed&gt;</div>") != std::string::npos);
+        }
+    };
+
+    class ArenaTest : public oatpp::test::UnitTest {
+    public:
+        ArenaTest() : oatpp::test::UnitTest("Arena") {}
+
+        struct Tracked {
+            Tracked(std::vector<int> &log, int n) : log(log), n(n) {}
+            ~Tracked() { log.push_back(n); }
+            std::vector<int> &log;
+            int n;
+        };
+
+        void onRun() override {
+            std::vector<int> log;
+            {
+                GridIron::Arena arena;
+                for (int i = 0; i < 1000; ++i) // well past the inline buffer
+                    arena.Create<Tracked>(log, i);
+                OATPP_ASSERT(*arena.Create<int>(42) == 42);
+            }
+            // everything destroyed, newest first
+            OATPP_ASSERT(log.size() == 1000);
+            OATPP_ASSERT(log.front() == 999 && log.back() == 0);
+
+            // controls made on a page belong to it
+            {
+                GridIron::Page page("");
+                auto label = page.Create<GridIron::controls::Label>("lblTest", "text");
+                OATPP_ASSERT(page.Registry().Find("lblTest") == label);
+                OATPP_ASSERT(page.FindByID("lblTest") == label);
+                OATPP_ASSERT(label->GetPage() == &page);
+            }
+        }
+    };
+
+    class RegistryTest : public oatpp::test::UnitTest {
+    public:
+        RegistryTest() : oatpp::test::UnitTest("Registry") {}
+
+        void onRun() override {
+            std::vector<std::unique_ptr<GridIron::controls::Label>> labels;
+            for (int i = 0; i < 100; ++i)
+                labels.push_back(std::make_unique<GridIron::controls::Label>("lbl" + std::to_string(i), nullptr));
+
+            // register/unregister churn on a long-lived registry keeps rehashing the same tables
+            GridIron::ControlRegistry registry;
+            OATPP_ASSERT(registry.Register(labels[0].get()));
+            OATPP_ASSERT(!registry.Register(labels[0].get()));
+            for (int round = 0; round < 1000; ++round)
+            {
+                for (size_t i = 1; i < labels.size(); ++i)
+                    OATPP_ASSERT(registry.Register(labels[i].get()));
+                for (size_t i = 1; i < labels.size(); ++i)
+                    OATPP_ASSERT(registry.Unregister(labels[i].get()));
+            }
+            OATPP_ASSERT(registry.Count() == 1);
+            OATPP_ASSERT(registry.Find("lbl0") == labels[0].get());
+            OATPP_ASSERT(registry.Find("lbl1") == nullptr);
+        }
+    };
+
+    class VariableSlotTest : public oatpp::test::UnitTest {
+    public:
+        VariableSlotTest() : oatpp::test::UnitTest("VariableSlots") {}
+
+        void onRun() override {
+            auto compiled = std::make_shared<const GridIron::Template>(
+                "::test::", "<p><GridIron::Value key=\"name\" />, <GridIron::Value key=\"name\" /></p>");
+            OATPP_ASSERT(compiled->ValueCount() == 1);
+            OATPP_ASSERT(compiled->ValueSlot("name") == 0);
+            OATPP_ASSERT(compiled->ValueSlot("other") == GridIron::Template::npos);
+
+            GridIron::Page page("test", compiled);
+            std::string name = "gridiron", other = "unused";
+            OATPP_ASSERT(page.RegisterVariable("name", &name));
+            OATPP_ASSERT(!page.RegisterVariable("name", &other)); // already bound
+            OATPP_ASSERT(page.RegisterVariable("other", &other)); // not on the page, kept by name
+            OATPP_ASSERT(!page.RegisterVariable("bad name", &other));
+            OATPP_ASSERT(page.GetVariable("other") == &other);
+
+            std::string data;
+            page.render(data);
+            OATPP_ASSERT(data == "<p>gridiron, gridiron</p>");
+        }
+    };
+
+    class PrecompiledTemplateTest : public oatpp::test::UnitTest {
+    public:
+        PrecompiledTemplateTest() : oatpp::test::UnitTest("PrecompiledTemplate") {}
+
+        void onRun() override {
+            // what gridiron-templatec would emit for this page, taken from the runtime compiler
+            static const std::string html =
+                "<GridIron::Page lang=\"en\"><GridIron::Label auto=\"true\" id=\"lbl\">text</GridIron::Label>"
+                "<GridIron::Value key=\"lbl.Text\" /></GridIron::Page>";
+            GridIron::Template parsed("::test::", html);
+
+            std::vector<GridIron::PrecompiledControl> controls;
+            for (size_t slot = 0; slot < parsed.ControlCount(); ++slot) {
+                const GridIron::htmlnode &node = parsed.ControlNode(slot);
+                controls.push_back({node.tagName(), node.offset(), node.length(), node.text().length(),
+                                    node.closingText().length()});
+            }
+            std::vector<std::string_view> keys;
+            for (size_t slot = 0; slot < parsed.ValueCount(); ++slot)
+                keys.push_back(parsed.ValueKey(slot));
+
+            const GridIron::PrecompiledTemplate definition{"::test::", html, parsed.Plan().data(), parsed.Plan().size(),
+                                                           controls.data(), parsed.Controls().data(), controls.size(),
+                                                           keys.data(), keys.size()};
+            auto compiled = std::make_shared<const GridIron::Template>(definition);
+            OATPP_ASSERT(compiled->ControlCount() == 1);
+            OATPP_ASSERT(compiled->ValueSlot("lbl.Text") == 0);
+
+            // the html, plan and binding index are used where they are, not copied
+            OATPP_ASSERT(compiled->Data().data() == html.data() && compiled->Plan().data() == parsed.Plan().data());
+            OATPP_ASSERT(compiled->Controls().data() == parsed.Controls().data());
+            const GridIron::ControlTag &tag = compiled->Controls()[0];
+            OATPP_ASSERT(tag.id == "lbl" && tag.type == "Label" && tag.autonomous);
+            OATPP_ASSERT(tag.Attribute("auto") == "true" && tag.Attribute("style").empty());
+
+            std::string expected, actual;
+            GridIron::Page("parsed", std::shared_ptr<const GridIron::Template>(&parsed, [](const GridIron::Template *) {})).render(expected);
+            GridIron::Page("compiled", compiled).render(actual);
+            OATPP_ASSERT(actual == expected);
+        }
+    };
+
+    class StaticPreloadTest : public oatpp::test::UnitTest {
+    public:
+        StaticPreloadTest() : oatpp::test::UnitTest("StaticPreload") {}
+
+        void onRun() override {
+            // preload.cpp compiled this during static initialization, the control tag must still be recognized
+            auto preloaded = GridIron::TemplateCache::Instance().Get(GridIron::test::StaticPreloadPage);
+            OATPP_ASSERT(preloaded->ControlCount() == 1);
+            OATPP_ASSERT(preloaded->Controls()[0].type == "Label");
+
+            std::string output;
+            GridIron::Page(GridIron::test::StaticPreloadPage).render(output);
+            OATPP_ASSERT(output.find("id=\"lblStatic\">static</div>") != std::string::npos);
+        }
+    };
+
     void runTests() {
 
         OATPP_LOGD("test", "insert oatpp-swagger tests here");
 
         OATPP_RUN_TEST(Test);
+        OATPP_RUN_TEST(XmlEncodeTest);
+        OATPP_RUN_TEST(ParseTagTest);
+        OATPP_RUN_TEST(TokenizerTest);
+        OATPP_RUN_TEST(OutputCacheTest);
+        OATPP_RUN_TEST(TagTest);
+        OATPP_RUN_TEST(RefreshTest);
+        OATPP_RUN_TEST(ViewStateTest);
+        OATPP_RUN_TEST(PostBackTest);
+        OATPP_RUN_TEST(ParallelRenderTest);
+        OATPP_RUN_TEST(AsyncRenderTest);
+        OATPP_RUN_TEST(FlushTest);
+        OATPP_RUN_TEST(RenderBufferTest);
+        OATPP_RUN_TEST(StaticFragmentTest);
+        OATPP_RUN_TEST(ArenaTest);
+        OATPP_RUN_TEST(RegistryTest);
+        OATPP_RUN_TEST(VariableSlotTest);
+        OATPP_RUN_TEST(PrecompiledTemplateTest);
+        OATPP_RUN_TEST(StaticPreloadTest);
 
     }
 
@@ -0,0 +1,278 @@
+/****************************************************************************************
+ * (C) Copyright 2009-2024
+ *    Jessica Mulein <jessica@digitaldefiance.org>
+ *    Digital Defiance and Contributors <https://digitaldefiance.org>
+ *
+ * Others will be credited if more developers join.
+ *
+ * License
+ *
+ * This code is licensed under the Apache license.
+ * Please see COPYING in the root of this package for details.
+ *
+ * The following libraries are only linked in, and no code is based directly from them:
+ * htmlcxx is under the Apache 2.0 License
+ ***************************************************************************************
+ * HtmlTokenizer Class
+ * -------------------
+ *
+ * Single forward scan for our tags. See tokenizer.hpp.
+ ***************************************************************************************/
+
+#include <gridiron/tokenizer.hpp>
+#include <gridiron/gridiron.hpp>
+
+namespace GridIron
+{
+    static constexpr size_t npos = std::string_view::npos;
+
+    static inline bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\f'; }
+    static inline bool isAlpha(char c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'); }
+
+    // ascii case-insensitive compare of text at offset with a lowercase word
+    static bool matchesLower(std::string_view data, size_t offset, std::string_view word)
+    {
+        if (data.size() - offset < word.size())
+            return false;
+        for (size_t i = 0; i < word.size(); ++i)
+        {
+            char c = data[offset + i];
+            if (c >= 'A' && c <= 'Z')
+                c = static_cast<char>(c - 'A' + 'a');
+            if (c != word[i])
+                return false;
+        }
+        return true;
+    }
+
+    // script and style hold text, not markup. A '<' in there is never a tag.
+    static size_t rawTextEnd(std::string_view data, size_t from, std::string_view closing)
+    {
+        for (size_t p = data.find('<', from); p != npos; p = data.find('<', p + 1))
+        {
+            if (matchesLower(data, p, closing))
+                return p;
+        }
+        return npos;
+    }
+
+    std::string_view HtmlToken::Attribute(std::string_view attributeName) const
+    {
+        for (const tag_attribute &attribute : attributes)
+        {
+            if (attribute.first == attributeName)
+                return attribute.second;
+        }
+        return std::string_view();
+    }
+
+    bool HtmlToken::HasAttribute(std::string_view attributeName) const
+    {
+        for (const tag_attribute &attribute : attributes)
+        {
+            if (attribute.first == attributeName)
+                return true;
+        }
+        return false;
+    }
+
+    size_t HtmlTokenizer::nameEnd(size_t from) const
+    {
+        while (from < _data.size() && !isSpace(_data[from]) && _data[from] != '>' && _data[from] != '/')
+            ++from;
+        return from;
+    }
+
+    bool HtmlTokenizer::isOurs(std::string_view name) const
+    {
+        return !_ns.empty() && name.size() > _ns.size() && name[0] == _ns[0] && gridironParseTag(name).first == _ns;
+    }
+
+    // a quote only starts a quoted value right after an '=', so a stray apostrophe elsewhere can't swallow the page
+    size_t HtmlTokenizer::tagEnd(std::string_view data, size_t from)
+    {
+        bool afterEquals = false;
+        for (size_t i = from + 1; i < data.size(); ++i)
+        {
+            const char c = data[i];
+            if (c == '>')
+                return i + 1;
+            if (afterEquals && (c == '"' || c == '\''))
+            {
+                i = data.find(c, i + 1);
+                if (i == npos)
+                    return npos;
+                afterEquals = false;
+            }
+            else if (c == '=')
+            {
+                afterEquals = true;
+            }
+            else if (!isSpace(c))
+            {
+                afterEquals = false;
+            }
+        }
+        return npos;
+    }
+
+    size_t HtmlTokenizer::findTag(size_t from) const
+    {
+        while (from < _data.size())
+        {
+            const size_t p = _data.find('<', from);
+            if (p == npos || p + 1 >= _data.size())
+                return npos;
+
+            const char next = _data[p + 1];
+            if (next == '!' && _data.compare(p + 2, 2, "--") == 0)
+            {
+                // comment, tags in it don't count
+                const size_t end = _data.find("-->", p + 4);
+                if (end == npos)
+                    return npos;
+                from = end + 3;
+            }
+            else if (next == '!' || next == '?')
+            {
+                // doctype, cdata, processing instruction
+                const size_t end = _data.find('>', p + 2);
+                if (end == npos)
+                    return npos;
+                from = end + 1;
+            }
+            else if (next == '/')
+            {
+                if (isOurs(_data.substr(p + 2, nameEnd(p + 2) - (p + 2))))
+                    return p;
+                from = p + 2;
+            }
+            else if (isAlpha(next))
+            {
+                const std::string_view name = _data.substr(p + 1, nameEnd(p + 1) - (p + 1));
+                if (isOurs(name))
+                    return p;
+
+                // skip the whole tag, so a '<' inside an attribute value isn't taken for a tag
+                from = tagEnd(_data, p);
+                if (from == npos)
+                    return npos;
+                if (name.size() == 6 && matchesLower(name, 0, "script"))
+                    from = rawTextEnd(_data, from, "</script");
+                else if (name.size() == 5 && matchesLower(name, 0, "style"))
+                    from = rawTextEnd(_data, from, "</style");
+            }
+            else
+            {
+                // a lone '<' in text
+                from = p + 1;
+            }
+        }
+        return npos;
+    }
+
+    bool HtmlTokenizer::Next(HtmlToken &token)
+    {
+        if (_pos >= _data.size())
+            return false;
+
+        token.attributes.clear();
+        token.name = token.ns = token.tagType = std::string_view();
+
+        size_t start = findTag(_pos);
+        size_t end = npos;
+        if (start == _pos)
+        {
+            // one of ours. If it never ends, it (and the rest of the page) is just text.
+            end = (_data[start + 1] == '/') ? _data.find('>', start) : tagEnd(_data, start);
+            if (end != npos && _data[start + 1] == '/')
+                ++end;
+        }
+        if (start != _pos || end == npos)
+        {
+            const size_t literalEnd = (start == _pos || start == npos) ? _data.size() : start;
+            token.type = HtmlTokenType::Literal;
+            token.offset = _pos;
+            token.text = _data.substr(_pos, literalEnd - _pos);
+            _pos = literalEnd;
+            return true;
+        }
+
+        token.offset = start;
+        token.text = _data.substr(start, end - start);
+        _pos = end;
+
+        const size_t nameStart = start + ((_data[start + 1] == '/') ? 2 : 1);
+        token.name = _data.substr(nameStart, nameEnd(nameStart) - nameStart);
+        auto parsed = gridironParseTag(token.name);
+        token.ns = parsed.first;
+        token.tagType = parsed.second;
+
+        if (_data[start + 1] == '/')
+        {
+            token.type = HtmlTokenType::Close;
+        }
+        else
+        {
+            ParseAttributes(token.text, token.attributes);
+            token.type = (token.text.size() >= 2 && token.text[token.text.size() - 2] == '/') ? HtmlTokenType::SelfClosing
+                                                                                               : HtmlTokenType::Open;
+        }
+        return true;
+    }
+
+    bool HtmlTokenizer::ParseAttributes(std::string_view tag, std::vector<tag_attribute> &attributes)
+    {
+        attributes.clear();
+
+        // past "<name"
+        size_t i = 1;
+        while (i < tag.size() && !isSpace(tag[i]) && tag[i] != '>' && tag[i] != '/')
+            ++i;
+
+        while (i < tag.size())
+        {
+            while (i < tag.size() && (isSpace(tag[i]) || tag[i] == '/'))
+                ++i;
+            if (i >= tag.size())
+                return false;
+            if (tag[i] == '>')
+                return true;
+
+            const size_t nameStart = i;
+            while (i < tag.size() && !isSpace(tag[i]) && tag[i] != '=' && tag[i] != '>' && tag[i] != '/')
+                ++i;
+            const std::string_view name = tag.substr(nameStart, i - nameStart);
+
+            while (i < tag.size() && isSpace(tag[i]))
+                ++i;
+            std::string_view value;
+            if (i < tag.size() && tag[i] == '=')
+            {
+                ++i;
+                while (i < tag.size() && isSpace(tag[i]))
+                    ++i;
+                if (i < tag.size() && (tag[i] == '"' || tag[i] == '\''))
+                {
+                    const size_t close = tag.find(tag[i], i + 1);
+                    if (close == npos)
+                        return false;
+                    value = tag.substr(i + 1, close - i - 1);
+                    i = close + 1;
+                }
+                else
+                {
+                    // unquoted, up to whitespace or the end of the tag ("/>" included)
+                    const size_t valueStart = i;
+                    while (i < tag.size() && !isSpace(tag[i]) && tag[i] != '>' &&
+                           !(tag[i] == '/' && i + 1 < tag.size() && tag[i + 1] == '>'))
+                        ++i;
+                    value = tag.substr(valueStart, i - valueStart);
+                }
+            }
+            if (!name.empty())
+                attributes.emplace_back(name, value);
+        }
+        return false;
+    }
+}
@@ -0,0 +1,386 @@
+/****************************************************************************************
+ * (C) Copyright 2009-2024
+ *    Jessica Mulein <jessica@digitaldefiance.org>
+ *    Digital Defiance and Contributors <https://digitaldefiance.org>
+ *
+ * Others will be credited if more developers join.
+ *
+ * License
+ *
+ * This code is licensed under the Apache license.
+ * Please see COPYING in the root of this package for details.
+ *
+ * The following libraries are only linked in, and no code is based directly from them:
+ * htmlcxx is under the Apache 2.0 License
+ ***************************************************************************************
+ * gridiron-templatec
+ * ------------------
+ *
+ * Build-time template compiler. Parses a front page exactly as the TemplateCache would
+ * and writes it out as C++: the html, render plan and control index as constexpr data,
+ * plus the ids of its controls and the names of its variables as constants with typed
+ * accessors. The generated source preloads the TemplateCache, so the page is never read
+ * or compiled at runtime (only a control's htmlnode is made from its tag, when a page
+ * first binds it), and referring to a control the page doesn't have fails to compile.
+ *
+ *   gridiron-templatec <front page> <input.html> <identifier> <output.hpp> <output.cpp>
+ *
+ * Normally run through gridiron_compile_templates() in cmake/GridIronTemplates.cmake.
+ ***************************************************************************************/
+
+#include <gridiron/gridiron.hpp>
+#include <gridiron/exceptions.hpp>
+#include <gridiron/template.hpp>
+
+#include <cctype>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace GridIron;
+
+namespace
+{
+    // same rule as cmake's string(MAKE_C_IDENTIFIER)
+    std::string identifier(std::string_view name)
+    {
+        std::string result;
+        if (name.empty() || std::isdigit(static_cast<unsigned char>(name[0])))
+            result.push_back('_');
+        for (char c : name)
+            result.push_back(std::isalnum(static_cast<unsigned char>(c)) ? c : '_');
+        return result;
+    }
+
+    // a C++ string literal for arbitrary bytes. Octal escapes are always three digits so they can't run into what follows.
+    void writeLiteral(std::ostream &os, std::string_view text)
+    {
+        static const char digits[] = "01234567";
+        os << '"';
+        for (char c : text)
+        {
+            const unsigned char u = static_cast<unsigned char>(c);
+            switch (c)
+            {
+            case '\\':
+                os << "\\\\";
+                break;
+            case '"':
+                os << "\\\"";
+                break;
+            case '\n':
+                os << "\\n";
+                break;
+            case '\t':
+                os << "\\t";
+                break;
+            default:
+                if (u < 0x20 || u == 0x7f)
+                    os << '\\' << digits[(u >> 6) & 7] << digits[(u >> 3) & 7] << digits[u & 7];
+                else
+                    os << c;
+            }
+        }
+        os << '"';
+    }
+
+    // long text as one literal per line, the compiler joins them back up
+    void writeLines(std::ostream &os, std::string_view text, const char *indent)
+    {
+        size_t start = 0;
+        while (start < text.size())
+        {
+            size_t end = text.find('\n', start);
+            end = (end == std::string_view::npos) ? text.size() : end + 1;
+            os << indent;
+            writeLiteral(os, text.substr(start, end - start));
+            os << '\n';
+            start = end;
+        }
+    }
+
+    // the generated names must be unique within their namespace
+    std::string uniqueName(std::set<std::string> &taken, std::string name)
+    {
+        std::string candidate = name;
+        for (int n = 2; !taken.insert(candidate).second; ++n)
+            candidate = name + "_" + std::to_string(n);
+        return candidate;
+    }
+
+    std::string lowercase(std::string_view text)
+    {
+        std::string result(text);
+        for (char &c : result)
+            c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        return result;
+    }
+
+    struct ControlInfo
+    {
+        std::string id;
+        std::string type;
+        std::string name; // accessor name
+    };
+
+    void writeHeader(std::ostream &os, const std::string &frontPage, const std::string &ident,
+                     const std::vector<ControlInfo> &controls, const Template &compiled)
+    {
+        std::string guard = "_GRIDIRON_COMPILED_" + ident + "_HPP_";
+        for (char &c : guard)
+            c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+
+        os << "// generated by gridiron-templatec from " << frontPage << ". Do not edit, edit the html.\n\n"
+           << "#ifndef " << guard << "\n#define " << guard << "\n\n"
+           << "#include <gridiron/template.hpp>\n"
+           << "#include <gridiron/controls/page.hpp>\n";
+
+        // control classes live in GridIron::controls, declared in controls/ui/<type>.hpp
+        std::set<std::string> types;
+        for (const ControlInfo &control : controls)
+            types.insert(control.type);
+        for (const std::string &type : types)
+            os << "#include <gridiron/controls/ui/" << lowercase(type) << ".hpp>\n";
+
+        os << "#include <memory>\n#include <string>\n#include <string_view>\n\n"
+           << "namespace GridIron::compiled::" << ident << "\n{\n"
+           << "    constexpr std::string_view FrontPage = ";
+        writeLiteral(os, frontPage);
+        os << ";\n\n"
+           << "    extern const PrecompiledTemplate Definition;\n\n"
+           << "    // the compiled template, built on first use\n"
+           << "    std::shared_ptr<const Template> Load();\n\n"
+           << "    // serve requests for the front page by name with the compiled template, the file isn't needed at runtime.\n"
+           << "    // Call from main, not from a static initializer.\n"
+           << "    void Preload();\n\n";
+
+        os << "    // ids of the controls on the page\n    namespace ids\n    {\n";
+        for (const ControlInfo &control : controls)
+        {
+            os << "        constexpr std::string_view " << control.name << " = ";
+            writeLiteral(os, control.id);
+            os << ";\n";
+        }
+        os << "    }\n\n";
+
+        os << "    // variables the page's Value tags show\n    namespace values\n    {\n";
+        std::set<std::string> valueNames;
+        for (size_t slot = 0; slot < compiled.ValueCount(); ++slot)
+        {
+            os << "        constexpr std::string_view " << uniqueName(valueNames, identifier(compiled.ValueKey(slot))) << " = ";
+            writeLiteral(os, compiled.ValueKey(slot));
+            os << ";\n";
+        }
+        os << "    }\n";
+
+        for (const ControlInfo &control : controls)
+        {
+            os << "\n    // <" << HtmlNamespace << "::" << control.type << " id=\"" << control.id << "\">, nullptr until it exists on the page\n"
+               << "    inline ::GridIron::controls::" << control.type << " *" << control.name << "(Page &page)\n    {\n"
+               << "        return dynamic_cast<::GridIron::controls::" << control.type
+               << " *>(page.FindByID(std::string(ids::" << control.name << "), true));\n    }\n";
+        }
+
+        os << "}\n\n#endif\n";
+    }
+
+    // a view of the page as a constant expression: into Html if that's where it points, else its own literal
+    void writeView(std::ostream &os, std::string_view data, std::string_view view)
+    {
+        if (view.empty())
+            os << "std::string_view()";
+        else if (view.data() >= data.data() && view.data() + view.size() <= data.data() + data.size())
+            os << "std::string_view(Html + " << (view.data() - data.data()) << ", " << view.size() << ")";
+        else
+        {
+            // e.g. a tag the template rewrote, <GridIron::Page> -> <html>
+            os << "std::string_view(";
+            writeLiteral(os, view);
+            os << ", " << view.size() << ")";
+        }
+    }
+
+    void writeSource(std::ostream &os, const std::string &frontPage, const std::string &ident, const std::string &header,
+                     const Template &compiled)
+    {
+        const std::string_view data = compiled.Data();
+
+        os << "// generated by gridiron-templatec from " << frontPage << ". Do not edit, edit the html.\n\n"
+           << "#include \"" << header << "\"\n\n"
+           << "namespace GridIron::compiled::" << ident << "\n{\n    namespace\n    {\n";
+
+        os << "        constexpr char Html[] =\n";
+        writeLines(os, data, "            ");
+        os << "            ;\n\n";
+
+        os << "        constexpr RenderOp Plan[] = {\n";
+        for (const RenderOp &op : compiled.Plan())
+        {
+            switch (op.type)
+            {
+            case RenderOpType::Literal:
+                os << "            {RenderOpType::Literal, ";
+                writeView(os, data, op.text);
+                os << ", 0},\n";
+                break;
+            case RenderOpType::Control:
+                os << "            {RenderOpType::Control, std::string_view(), " << op.slot << "},\n";
+                break;
+            case RenderOpType::Value:
+                os << "            {RenderOpType::Value, std::string_view(), " << op.slot << "},\n";
+                break;
+            case RenderOpType::Flush:
+                os << "            {RenderOpType::Flush, std::string_view(), 0},\n";
+                break;
+            }
+        }
+        os << "        };\n";
+
+        if (compiled.ControlCount() > 0)
+        {
+            os << "\n        constexpr PrecompiledControl Controls[] = {\n";
+            for (size_t slot = 0; slot < compiled.ControlCount(); ++slot)
+            {
+                const htmlnode &node = compiled.ControlNode(slot);
+                os << "            {";
+                writeLiteral(os, node.tagName());
+                os << ", " << node.offset() << ", " << node.length() << ", " << node.text().length() << ", "
+                   << node.closingText().length() << "},\n";
+            }
+            os << "        };\n";
+
+            // the binding index, attributes of every tag in one array
+            size_t attributeCount = 0;
+            for (const ControlTag &tag : compiled.Controls())
+                attributeCount += tag.attributeCount;
+            if (attributeCount > 0)
+            {
+                os << "\n        constexpr tag_attribute Attributes[] = {\n";
+                for (const ControlTag &tag : compiled.Controls())
+                {
+                    for (size_t i = 0; i < tag.attributeCount; ++i)
+                    {
+                        os << "            {";
+                        writeView(os, data, tag.attributes[i].first);
+                        os << ", ";
+                        writeView(os, data, tag.attributes[i].second);
+                        os << "},\n";
+                    }
+                }
+                os << "        };\n";
+            }
+
+            os << "\n        constexpr ControlTag Tags[] = {\n";
+            size_t attribute = 0;
+            for (const ControlTag &tag : compiled.Controls())
+            {
+                os << "            {";
+                writeView(os, data, tag.id);
+                os << ", ";
+                writeView(os, data, tag.type);
+                os << ", " << (tag.autonomous ? "true" : "false") << ", ";
+                if (tag.attributeCount > 0)
+                    os << "Attributes + " << attribute;
+                else
+                    os << "nullptr";
+                os << ", " << tag.attributeCount << "},\n";
+                attribute += tag.attributeCount;
+            }
+            os << "        };\n";
+        }
+
+        if (compiled.ValueCount() > 0)
+        {
+            os << "\n        constexpr std::string_view ValueKeys[] = {\n";
+            for (size_t slot = 0; slot < compiled.ValueCount(); ++slot)
+            {
+                os << "            ";
+                writeLiteral(os, compiled.ValueKey(slot));
+                os << ",\n";
+            }
+            os << "        };\n";
+        }
+        os << "    }\n\n";
+
+        os << "    const PrecompiledTemplate Definition{FrontPage, std::string_view(Html, sizeof(Html) - 1),\n"
+           << "                                         Plan, " << compiled.Plan().size() << ",\n"
+           << "                                         " << (compiled.ControlCount() > 0 ? "Controls, Tags" : "nullptr, nullptr")
+           << ", " << compiled.ControlCount() << ",\n"
+           << "                                         " << (compiled.ValueCount() > 0 ? "ValueKeys" : "nullptr") << ", "
+           << compiled.ValueCount() << "};\n\n"
+           << "    std::shared_ptr<const Template> Load()\n    {\n"
+           << "        static const std::shared_ptr<const Template> compiled = std::make_shared<const Template>(Definition);\n"
+           << "        return compiled;\n    }\n\n"
+           << "    void Preload()\n    {\n"
+           << "        TemplateCache::Instance().Preload(std::string(FrontPage), Load());\n    }\n"
+           << "}\n";
+    }
+
+    bool writeFile(const std::string &path, const std::string &contents)
+    {
+        std::ofstream out(path, std::ios_base::binary | std::ios_base::trunc);
+        out << contents;
+        return static_cast<bool>(out);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 6)
+    {
+        std::cerr << "usage: " << argv[0] << " <front page> <input.html> <identifier> <output.hpp> <output.cpp>" << std::endl;
+        return 2;
+    }
+    const std::string frontPage = argv[1];
+    const std::string input = argv[2];
+    const std::string ident = identifier(argv[3]);
+    const std::string headerPath = argv[4];
+    const std::string sourcePath = argv[5];
+
+    try
+    {
+        std::shared_ptr<const Template> compiled = Template::FromFile(input);
+
+        std::vector<ControlInfo> controls;
+        std::set<std::string> names;
+        for (size_t slot = 0; slot < compiled->ControlCount(); ++slot)
+        {
+            const ControlTag &tag = compiled->Controls()[slot];
+            if (tag.id.empty())
+            {
+                std::cerr << input << ": control tag without an id: " << compiled->ControlNode(slot).text() << std::endl;
+                return 1;
+            }
+            for (const ControlInfo &control : controls)
+            {
+                if (control.id == tag.id)
+                {
+                    std::cerr << input << ": id used twice: " << tag.id << std::endl;
+                    return 1;
+                }
+            }
+            controls.push_back(ControlInfo{std::string(tag.id), std::string(tag.type), uniqueName(names, identifier(tag.id))});
+        }
+
+        std::ostringstream header, source;
+        writeHeader(header, frontPage, ident, controls, *compiled);
+        const std::string headerName = headerPath.substr(headerPath.find_last_of("/\\") + 1);
+        writeSource(source, frontPage, ident, headerName, *compiled);
+
+        if (!writeFile(headerPath, header.str()) || !writeFile(sourcePath, source.str()))
+        {
+            std::cerr << "unable to write " << headerPath << " / " << sourcePath << std::endl;
+            return 1;
+        }
+    }
+    catch (const GridException &e)
+    {
+        std::cerr << input << ": " << e.string() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,382 @@
+/****************************************************************************************
+ * (C) Copyright 2009-2024
+ *    Jessica Mulein <jessica@digitaldefiance.org>
+ *    Digital Defiance and Contributors <https://digitaldefiance.org>
+ *
+ * Others will be credited if more developers join.
+ *
+ * License
+ *
+ * This code is licensed under the Apache license.
+ * Please see COPYING in the root of this package for details.
+ *
+ * The following libraries are only linked in, and no code is based directly from them:
+ * htmlcxx is under the Apache 2.0 License
+ ***************************************************************************************
+ * ViewState Classes
+ * -----------------
+ *
+ * Binary ViewState writer and parser. See viewstate.hpp for the format.
+ ***************************************************************************************/
+
+#include <gridiron/viewstate.hpp>
+#include <gridiron/hmac.hpp>
+#include <array>
+#include <random>
+
+#ifdef GRIDIRON_VIEWSTATE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace GridIron
+{
+    // bodies smaller than this aren't worth deflating
+    static constexpr size_t CompressThreshold = 256;
+    static constexpr size_t HeaderSize = 2;
+    static constexpr size_t MacSize = sizeof(sha256_digest);
+
+    static void appendVarint(std::string &out, uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<char>(value));
+    }
+
+    static bool readVarint(std::string_view &in, uint64_t &value)
+    {
+        value = 0;
+        for (int shift = 0; shift < 64 && !in.empty(); shift += 7)
+        {
+            const uint8_t byte = static_cast<uint8_t>(in.front());
+            in.remove_prefix(1);
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0)
+                return true;
+        }
+        return false;
+    }
+
+    static void appendBytes(std::string &out, std::string_view bytes)
+    {
+        appendVarint(out, bytes.size());
+        out.append(bytes.data(), bytes.size());
+    }
+
+    static bool readBytes(std::string_view &in, std::string_view &bytes)
+    {
+        uint64_t length;
+        if (!readVarint(in, length) || length > in.size())
+            return false;
+        bytes = in.substr(0, static_cast<size_t>(length));
+        in.remove_prefix(static_cast<size_t>(length));
+        return true;
+    }
+
+    // the scope is authenticated along with the token without being sent in it
+    static sha256_digest tokenMac(std::string_view key, std::string_view scope, std::string_view token)
+    {
+        std::string input;
+        input.reserve(scope.size() + token.size() + 10);
+        appendBytes(input, scope);
+        input.append(token.data(), token.size());
+        return HmacSha256(key, input);
+    }
+
+    // url-safe alphabet and no padding, nothing in it needs escaping in a form field or a query string
+    static const char Base64Alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+    static std::string base64Encode(std::string_view data)
+    {
+        std::string out;
+        out.reserve((data.size() + 2) / 3 * 4);
+        size_t i = 0;
+        for (; i + 3 <= data.size(); i += 3)
+        {
+            const uint32_t n = (uint32_t(uint8_t(data[i])) << 16) | (uint32_t(uint8_t(data[i + 1])) << 8) | uint8_t(data[i + 2]);
+            out.push_back(Base64Alphabet[(n >> 18) & 63]);
+            out.push_back(Base64Alphabet[(n >> 12) & 63]);
+            out.push_back(Base64Alphabet[(n >> 6) & 63]);
+            out.push_back(Base64Alphabet[n & 63]);
+        }
+        if (i < data.size())
+        {
+            uint32_t n = uint32_t(uint8_t(data[i])) << 16;
+            if (i + 1 < data.size())
+                n |= uint32_t(uint8_t(data[i + 1])) << 8;
+            out.push_back(Base64Alphabet[(n >> 18) & 63]);
+            out.push_back(Base64Alphabet[(n >> 12) & 63]);
+            if (i + 1 < data.size())
+                out.push_back(Base64Alphabet[(n >> 6) & 63]);
+        }
+        return out;
+    }
+
+    static bool base64Decode(std::string_view text, std::string &out)
+    {
+        static const auto table = []
+        {
+            std::array<int8_t, 256> t;
+            t.fill(-1);
+            for (int i = 0; i < 64; ++i)
+                t[static_cast<uint8_t>(Base64Alphabet[i])] = static_cast<int8_t>(i);
+            return t;
+        }();
+
+        if (text.size() % 4 == 1)
+            return false;
+        out.clear();
+        out.reserve(text.size() / 4 * 3 + 2);
+        uint32_t n = 0;
+        int bits = 0;
+        for (char c : text)
+        {
+            const int8_t v = table[static_cast<uint8_t>(c)];
+            if (v < 0)
+                return false;
+            n = (n << 6) | static_cast<uint32_t>(v);
+            bits += 6;
+            if (bits >= 8)
+            {
+                bits -= 8;
+                out.push_back(static_cast<char>((n >> bits) & 0xff));
+            }
+        }
+        return true;
+    }
+
+    std::string_view ViewStateControl::Get(std::string_view name, std::string_view defaultValue) const
+    {
+        for (const auto &property : properties)
+        {
+            if (property.first == name)
+                return property.second;
+        }
+        return defaultValue;
+    }
+
+    bool ViewStateControl::Has(std::string_view name) const
+    {
+        for (const auto &property : properties)
+        {
+            if (property.first == name)
+                return true;
+        }
+        return false;
+    }
+
+    bool ViewStateControl::GetInt(std::string_view name, int64_t &value) const
+    {
+        for (const auto &property : properties)
+        {
+            if (property.first != name)
+                continue;
+            std::string_view in = property.second;
+            uint64_t zigzag;
+            if (!readVarint(in, zigzag) || !in.empty())
+                return false;
+            value = static_cast<int64_t>(zigzag >> 1) ^ -static_cast<int64_t>(zigzag & 1);
+            return true;
+        }
+        return false;
+    }
+
+    void ViewStateWriter::BeginControl(std::string_view id)
+    {
+        endControl();
+        _id.assign(id.data(), id.size());
+        _open = true;
+    }
+
+    void ViewStateWriter::Write(std::string_view name, std::string_view value)
+    {
+        if (!_open)
+            return;
+        auto interned = _nameIndex.emplace(std::string(name), _names.size());
+        if (interned.second)
+            _names.emplace_back(name);
+        appendVarint(_properties, interned.first->second);
+        appendBytes(_properties, value);
+        ++_propertyCount;
+    }
+
+    void ViewStateWriter::Write(std::string_view name, int64_t value)
+    {
+        std::string encoded;
+        appendVarint(encoded, (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+        Write(name, std::string_view(encoded));
+    }
+
+    // controls that wrote nothing are left out
+    void ViewStateWriter::endControl()
+    {
+        if (_open && _propertyCount > 0)
+        {
+            appendBytes(_body, _id);
+            appendVarint(_body, _propertyCount);
+            _body.append(_properties);
+            ++_controls;
+        }
+        _properties.clear();
+        _propertyCount = 0;
+        _open = false;
+    }
+
+    std::string ViewStateWriter::Finish(std::string_view key, std::string_view scope, bool compress)
+    {
+        endControl();
+
+        std::string body;
+        appendVarint(body, _names.size());
+        for (const std::string &name : _names)
+            appendBytes(body, name);
+        appendVarint(body, _controls);
+        body.append(_body);
+
+        std::string token;
+        token.push_back(static_cast<char>(ViewState::Version));
+        token.push_back(0);
+
+#ifdef GRIDIRON_VIEWSTATE_ZLIB
+        if (compress && body.size() >= CompressThreshold && body.size() <= ViewState::MaxBody)
+        {
+            uLongf deflatedSize = compressBound(static_cast<uLong>(body.size()));
+            std::string deflated(deflatedSize, '\0');
+            if (compress2(reinterpret_cast<Bytef *>(deflated.data()), &deflatedSize,
+                          reinterpret_cast<const Bytef *>(body.data()), static_cast<uLong>(body.size()), Z_BEST_SPEED) == Z_OK &&
+                deflatedSize + 4 < body.size())
+            {
+                token[1] = static_cast<char>(ViewState::FlagDeflated);
+                appendVarint(token, body.size());
+                token.append(deflated.data(), deflatedSize);
+                body.clear();
+            }
+        }
+#else
+        (void)compress;
+#endif
+        token.append(body);
+
+        const sha256_digest mac = tokenMac(key, scope, token);
+        token.append(reinterpret_cast<const char *>(mac.data()), mac.size());
+        return base64Encode(token);
+    }
+
+    static std::string &signingKey()
+    {
+        static std::string key = []
+        {
+            std::random_device random;
+            std::string generated(32, '\0');
+            for (char &c : generated)
+                c = static_cast<char>(random() & 0xff);
+            return generated;
+        }();
+        return key;
+    }
+
+    const std::string &ViewState::Key()
+    {
+        return signingKey();
+    }
+
+    void ViewState::SetKey(std::string key)
+    {
+        signingKey() = std::move(key);
+    }
+
+    bool ViewState::Parse(std::string_view token, std::string_view key, std::string_view scope)
+    {
+        _names.clear();
+        _controls.clear();
+        _inflated.clear();
+
+        if (!base64Decode(token, _decoded) || _decoded.size() < HeaderSize + MacSize)
+            return false;
+
+        // authenticate before looking at anything else
+        const std::string_view signedPart(_decoded.data(), _decoded.size() - MacSize);
+        const sha256_digest mac = tokenMac(key, scope, signedPart);
+        if (!ConstantTimeEquals(mac.data(), reinterpret_cast<const uint8_t *>(_decoded.data() + signedPart.size()), MacSize))
+            return false;
+
+        if (static_cast<uint8_t>(_decoded[0]) != Version)
+            return false;
+        const uint8_t flags = static_cast<uint8_t>(_decoded[1]);
+        std::string_view body = signedPart.substr(HeaderSize);
+
+        if (flags & FlagDeflated)
+        {
+#ifdef GRIDIRON_VIEWSTATE_ZLIB
+            uint64_t rawLength;
+            if (!readVarint(body, rawLength) || rawLength > MaxBody)
+                return false;
+            _inflated.resize(static_cast<size_t>(rawLength));
+            uLongf inflatedSize = static_cast<uLongf>(rawLength);
+            if (uncompress(reinterpret_cast<Bytef *>(_inflated.data()), &inflatedSize,
+                           reinterpret_cast<const Bytef *>(body.data()), static_cast<uLong>(body.size())) != Z_OK ||
+                inflatedSize != rawLength)
+                return false;
+            body = _inflated;
+#else
+            return false; // made by a build with zlib
+#endif
+        }
+        else if (flags != 0)
+        {
+            return false;
+        }
+
+        if (!parseBody(body))
+        {
+            _names.clear();
+            _controls.clear();
+            return false;
+        }
+        return true;
+    }
+
+    bool ViewState::parseBody(std::string_view body)
+    {
+        uint64_t count;
+        if (!readVarint(body, count) || count > body.size())
+            return false;
+        _names.resize(static_cast<size_t>(count));
+        for (std::string_view &name : _names)
+        {
+            if (!readBytes(body, name))
+                return false;
+        }
+
+        if (!readVarint(body, count) || count > body.size())
+            return false;
+        _controls.resize(static_cast<size_t>(count));
+        for (ViewStateControl &control : _controls)
+        {
+            uint64_t properties;
+            if (!readBytes(body, control.id) || !readVarint(body, properties) || properties > body.size())
+                return false;
+            control.properties.resize(static_cast<size_t>(properties));
+            for (auto &property : control.properties)
+            {
+                uint64_t name;
+                if (!readVarint(body, name) || name >= _names.size() || !readBytes(body, property.second))
+                    return false;
+                property.first = _names[static_cast<size_t>(name)];
+            }
+        }
+        return body.empty();
+    }
+
+    const ViewStateControl *ViewState::Find(std::string_view id) const
+    {
+        for (const ViewStateControl &control : _controls)
+        {
+            if (control.id == id)
+                return &control;
+        }
+        return nullptr;
+    }
+}
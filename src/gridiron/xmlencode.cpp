@@ -0,0 +1,285 @@
+/****************************************************************************************
+ * (C) Copyright 2009-2024
+ *    Jessica Mulein <jessica@digitaldefiance.org>
+ *    Digital Defiance and Contributors <https://digitaldefiance.org>
+ *
+ * Others will be credited if more developers join.
+ *
+ * License
+ *
+ * This code is licensed under the Apache license.
+ * Please see COPYING in the root of this package for details.
+ *
+ * The following libraries are only linked in, and no code is based directly from them:
+ * htmlcxx is under the Apache 2.0 License
+ ***************************************************************************************
+ * XML encoding
+ * ------------
+ *
+ * Everything user supplied goes through here on every render, so it is done in two
+ * cheap passes instead of find/replace: count the escapes (16 or 32 bytes at a time
+ * where the cpu allows it), size the output once, then copy the runs between
+ * escapes with memcpy. The vector versions are picked at runtime; anything else
+ * uses the scalar versions.
+ ***************************************************************************************/
+
+#include <gridiron/gridiron.hpp>
+#include <array>
+#include <cstring>
+#include <ostream>
+#include <istream>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define GRIDIRON_XMLENCODE_X86 1
+#include <immintrin.h>
+#endif
+
+namespace GridIron
+{
+    namespace
+    {
+        // entity for each character we escape, nullptr for everything else
+        const char *entity(char c)
+        {
+            switch (c)
+            {
+            case '&':
+                return "&amp;";
+            case '\"':
+                return "&quot;";
+            case '\'':
+                return "&apos;";
+            case '<':
+                return "&lt;";
+            case '>':
+                return "&gt;";
+            default:
+                return nullptr;
+            }
+        }
+
+        // how many bytes encoding a character adds (0 for characters left alone)
+        constexpr std::array<unsigned char, 256> makeGrowthTable()
+        {
+            std::array<unsigned char, 256> table{};
+            table[static_cast<unsigned char>('&')] = 4;  // &amp;
+            table[static_cast<unsigned char>('\"')] = 5; // &quot;
+            table[static_cast<unsigned char>('\'')] = 5; // &apos;
+            table[static_cast<unsigned char>('<')] = 3;  // &lt;
+            table[static_cast<unsigned char>('>')] = 3;  // &gt;
+            return table;
+        }
+        constexpr std::array<unsigned char, 256> growthTable = makeGrowthTable();
+
+        size_t growthScalar(const char *data, size_t length)
+        {
+            size_t growth = 0;
+            for (size_t i = 0; i < length; ++i)
+                growth += growthTable[static_cast<unsigned char>(data[i])];
+            return growth;
+        }
+
+        // index of the first character needing an escape, or length if there is none
+        size_t findScalar(const char *data, size_t length)
+        {
+            size_t i = 0;
+            while (i < length && growthTable[static_cast<unsigned char>(data[i])] == 0)
+                ++i;
+            return i;
+        }
+
+#ifdef GRIDIRON_XMLENCODE_X86
+        // SSE2 is part of x86-64, so this one needs no runtime check there
+
+        inline int popcount(unsigned int mask) { return __builtin_popcount(mask); }
+
+        size_t growthSSE2(const char *data, size_t length)
+        {
+            const __m128i amp = _mm_set1_epi8('&');
+            const __m128i quot = _mm_set1_epi8('\"');
+            const __m128i apos = _mm_set1_epi8('\'');
+            const __m128i lt = _mm_set1_epi8('<');
+            const __m128i gt = _mm_set1_epi8('>');
+
+            size_t growth = 0;
+            size_t i = 0;
+            for (; i + 16 <= length; i += 16)
+            {
+                const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+                const unsigned int m4 = _mm_movemask_epi8(_mm_cmpeq_epi8(v, amp));
+                const unsigned int m5 = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, quot), _mm_cmpeq_epi8(v, apos)));
+                const unsigned int m3 = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, lt), _mm_cmpeq_epi8(v, gt)));
+                growth += 4 * popcount(m4) + 5 * popcount(m5) + 3 * popcount(m3);
+            }
+            return growth + growthScalar(data + i, length - i);
+        }
+
+        size_t findSSE2(const char *data, size_t length)
+        {
+            const __m128i amp = _mm_set1_epi8('&');
+            const __m128i quot = _mm_set1_epi8('\"');
+            const __m128i apos = _mm_set1_epi8('\'');
+            const __m128i lt = _mm_set1_epi8('<');
+            const __m128i gt = _mm_set1_epi8('>');
+
+            size_t i = 0;
+            for (; i + 16 <= length; i += 16)
+            {
+                const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+                const __m128i hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, amp), _mm_cmpeq_epi8(v, quot)),
+                                                 _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, apos), _mm_cmpeq_epi8(v, lt)),
+                                                              _mm_cmpeq_epi8(v, gt)));
+                const unsigned int mask = _mm_movemask_epi8(hit);
+                if (mask != 0)
+                    return i + __builtin_ctz(mask);
+            }
+            return i + findScalar(data + i, length - i);
+        }
+
+        __attribute__((target("avx2"))) size_t growthAVX2(const char *data, size_t length)
+        {
+            const __m256i amp = _mm256_set1_epi8('&');
+            const __m256i quot = _mm256_set1_epi8('\"');
+            const __m256i apos = _mm256_set1_epi8('\'');
+            const __m256i lt = _mm256_set1_epi8('<');
+            const __m256i gt = _mm256_set1_epi8('>');
+
+            size_t growth = 0;
+            size_t i = 0;
+            for (; i + 32 <= length; i += 32)
+            {
+                const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+                const unsigned int m4 = _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, amp));
+                const unsigned int m5 = _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(v, quot), _mm256_cmpeq_epi8(v, apos)));
+                const unsigned int m3 = _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(v, lt), _mm256_cmpeq_epi8(v, gt)));
+                growth += 4 * popcount(m4) + 5 * popcount(m5) + 3 * popcount(m3);
+            }
+            return growth + growthSSE2(data + i, length - i);
+        }
+
+        __attribute__((target("avx2"))) size_t findAVX2(const char *data, size_t length)
+        {
+            const __m256i amp = _mm256_set1_epi8('&');
+            const __m256i quot = _mm256_set1_epi8('\"');
+            const __m256i apos = _mm256_set1_epi8('\'');
+            const __m256i lt = _mm256_set1_epi8('<');
+            const __m256i gt = _mm256_set1_epi8('>');
+
+            size_t i = 0;
+            for (; i + 32 <= length; i += 32)
+            {
+                const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+                const __m256i hit = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, amp), _mm256_cmpeq_epi8(v, quot)),
+                                                    _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, apos), _mm256_cmpeq_epi8(v, lt)),
+                                                                    _mm256_cmpeq_epi8(v, gt)));
+                const unsigned int mask = _mm256_movemask_epi8(hit);
+                if (mask != 0)
+                    return i + __builtin_ctz(mask);
+            }
+            return i + findSSE2(data + i, length - i);
+        }
+#endif
+
+        struct EncodeEngine
+        {
+            size_t (*growth)(const char *data, size_t length);
+            size_t (*find)(const char *data, size_t length);
+        };
+
+        const EncodeEngine &engine()
+        {
+            static const EncodeEngine selected = []() -> EncodeEngine
+            {
+#ifdef GRIDIRON_XMLENCODE_X86
+                __builtin_cpu_init();
+                if (__builtin_cpu_supports("avx2"))
+                    return EncodeEngine{growthAVX2, findAVX2};
+                if (__builtin_cpu_supports("sse2"))
+                    return EncodeEngine{growthSSE2, findSSE2};
+#endif
+                return EncodeEngine{growthScalar, findScalar};
+            }();
+            return selected;
+        }
+    }
+
+    size_t xmlEncodedLength(std::string_view data)
+    {
+        return data.size() + engine().growth(data.data(), data.size());
+    }
+
+    std::string &xmlEncode(std::string_view data, std::string &out)
+    {
+        const EncodeEngine &e = engine();
+        const size_t growth = e.growth(data.data(), data.size());
+        if (growth == 0)
+            return out.append(data.data(), data.size()); // the usual case: nothing to escape
+
+        const size_t start = out.size();
+        out.resize(start + data.size() + growth);
+        char *dest = &out[start];
+
+        const char *source = data.data();
+        size_t remaining = data.size();
+        while (remaining > 0)
+        {
+            const size_t run = e.find(source, remaining);
+            std::memcpy(dest, source, run);
+            dest += run;
+            source += run;
+            remaining -= run;
+            if (remaining == 0)
+                break;
+
+            const char *replacement = entity(*source);
+            const size_t replacementLength = std::strlen(replacement);
+            std::memcpy(dest, replacement, replacementLength);
+            dest += replacementLength;
+            ++source;
+            --remaining;
+        }
+        return out;
+    }
+
+    std::ostream &xmlEncode(std::string_view data, std::ostream &os)
+    {
+        const EncodeEngine &e = engine();
+        const char *source = data.data();
+        size_t remaining = data.size();
+        while (remaining > 0)
+        {
+            const size_t run = e.find(source, remaining);
+            os.write(source, run);
+            source += run;
+            remaining -= run;
+            if (remaining == 0)
+                break;
+
+            os << entity(*source);
+            ++source;
+            --remaining;
+        }
+        return os;
+    }
+
+    std::ostream &xmlEncode(std::ostream &dest, std::istream &source)
+    {
+        char c;
+        while (source.get(c))
+        {
+            const char *replacement = entity(c);
+            if (replacement != nullptr)
+                dest << replacement;
+            else
+                dest.put(c);
+        }
+        return dest;
+    }
+
+    std::string xmlEncode(std::string_view data)
+    {
+        std::string out;
+        xmlEncode(data, out);
+        return out;
+    }
+}